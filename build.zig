@@ -4,33 +4,38 @@ const mem = std.mem;
 const path = std.fs.path;
 
 const buildExe = @import("build/exe.zig");
+const buildTest = @import("build/test.zig");
 const compile_command = @import("build/compile_command.zig");
 
 pub fn build(b: *std.Build) void {
     const target = b.standardTargetOptions(.{});
     const optimize = b.standardOptimizeOption(.{});
+    const alloc_check = b.option(bool, "alloc-check", "Abort on heap allocations in the predictor sample loops") orelse false;
 
-    var flags = [_][]const u8{
+    var flags = std.ArrayList([]const u8).init(b.allocator);
+    flags.appendSlice(&.{
         "-std=c++23",
         "-fexperimental-library",
         "-mavx2",
-        "",
-        "",
-        "",
-    };
+    }) catch @panic("OOM");
 
     if (optimize == .ReleaseFast) {
-        flags = [_][]const u8{
-            "-std=c++23",
-            "-fexperimental-library",
-            "-mavx2",
+        flags.appendSlice(&.{
             "-Ofast",
             "-march=native",
             "-flto=full",
-        };
+        }) catch @panic("OOM");
     }
 
-    const exe = buildExe.set(b, target, optimize, &flags);
+    // the test always runs with the allocation check
+    var test_flags = flags.clone() catch @panic("OOM");
+    test_flags.append("-DSAC_ALLOC_CHECK") catch @panic("OOM");
+    if (alloc_check) {
+        flags.append("-DSAC_ALLOC_CHECK") catch @panic("OOM");
+    }
+
+    const exe = buildExe.set(b, target, optimize, flags.items);
+    buildTest.set(b, target, optimize, test_flags.items);
 
     compile_command.generate(b, &[_]*std.Build.Step.Compile{exe});
 }
@@ -1,16 +1,17 @@
 const std = @import("std");
 
-const cppfiles = [_][]const u8{
-    "src/main.cpp",
-
+// everything but main, shared with the test
+pub const libfiles = [_][]const u8{
     "src/api/cli.cpp",
     "src/api/interface.cpp",
     "src/api/lib.cpp",
 
+    "src/common/alloccheck.cpp",
     "src/common/md5.cpp",
     "src/common/utils.cpp",
 
     "src/file/file.cpp",
+    "src/file/pcm.cpp",
     "src/file/sac.cpp",
     "src/file/wav.cpp",
 
@@ -38,7 +39,7 @@ pub fn set(b: *std.Build, target: std.Build.ResolvedTarget, optimize: std.builti
     });
 
     exe.addCSourceFiles(.{
-        .files = &cppfiles,
+        .files = &([_][]const u8{"src/main.cpp"} ++ libfiles),
         .flags = flags,
     });
 
@@ -0,0 +1,28 @@
+const std = @import("std");
+
+const buildExe = @import("exe.zig");
+
+// zig build test: round trip of a generated stereo signal, aborts if the
+// predictor sample loops allocate (flags must define SAC_ALLOC_CHECK)
+pub fn set(b: *std.Build, target: std.Build.ResolvedTarget, optimize: std.builtin.OptimizeMode, flags: []const []const u8) void {
+    const exe = b.addExecutable(.{
+        .name = "sac-test-alloccheck",
+        .target = target,
+        .optimize = optimize,
+    });
+
+    exe.addCSourceFiles(.{
+        .files = &([_][]const u8{"test/alloccheck.cpp"} ++ buildExe.libfiles),
+        .flags = flags,
+    });
+
+    if (target.result.abi != .msvc) {
+        exe.linkLibCpp();
+    } else {
+        exe.linkLibC();
+    }
+
+    const run = b.addRunArtifact(exe);
+    const step = b.step("test", "Encode and decode a generated signal with the allocation check");
+    step.dependOn(&run.step);
+}
@@ -82,6 +82,7 @@ Shell::CreateParamHandlers() {
   handlers["--DECODE"] = [](Shell& s, auto) { s.mode = Lib::Mode::DECODE; };
   handlers["--LIST"] = [](Shell& s, auto) { s.mode = Lib::Mode::LIST; };
   handlers["--LISTFULL"] = [](Shell& s, auto) { s.mode = Lib::Mode::LISTFULL; };
+  handlers["--TEST"] = [](Shell& s, auto) { s.mode = Lib::Mode::TEST; };
 
   // Verbosity level
   handlers["--VERBOSE"] = [](Shell& s, auto val) {
@@ -133,6 +134,11 @@ Shell::CreateParamHandlers() {
   handlers["--MT-MODE"] = [](Shell& s, auto val) {
     if(val.length()) { s.cfg.mt_mode = std::max(0, stoi(std::string(val))); }
   };
+  handlers["--FRAME-THREADS"] = [](Shell& s, auto val) {
+    if(val.length()) {
+      s.cfg.frame_threads = std::clamp(stoi(std::string(val)), 1, 256);
+    }
+  };
   handlers["--SPARSE-PCM"] = [](Shell& s, auto val) {
     if(val == "NO" || val == "0") {
       s.cfg.sparse_pcm = 0;
@@ -142,6 +148,7 @@ Shell::CreateParamHandlers() {
   };
   handlers["--STEREO-MS"] = [](Shell& s, auto) { s.cfg.stereo_ms = 1; };
   handlers["--OPT-RESET"] = [](Shell& s, auto) { s.cfg.ocfg.reset = 1; };
+  handlers["--OPT-WARM"] = [](Shell& s, auto) { s.cfg.ocfg.warm_start = 1; };
   handlers["--OPT-CFG"] = [](Shell& s, auto val) { s.HandleOptCfgParam(val); };
   handlers["--ADAPT-BLOCK"] = [](Shell& s, auto val) {
     if(val == "NO" || val == "0") {
@@ -150,6 +157,44 @@ Shell::CreateParamHandlers() {
       s.cfg.adapt_block = 1;
     }
   };
+  handlers["--START"] = [](Shell& s, auto val) {
+    if(val.length()) {
+      s.cfg.decode_start = std::max(0, stoi(std::string(val)));
+    }
+  };
+  handlers["--END"] = [](Shell& s, auto val) {
+    if(val.length()) {
+      s.cfg.decode_end = std::max(0, stoi(std::string(val)));
+    }
+  };
+  handlers["--SEEK-TABLE"] = [](Shell& s, auto val) {
+    if(val == "NO" || val == "0") {
+      s.cfg.seek_table = 0;
+    } else {
+      s.cfg.seek_table = 1;
+    }
+  };
+  handlers["--FAST-OLS"] = [](Shell& s, auto val) {
+    if(val == "NO" || val == "0") {
+      s.cfg.fast_ols = 0;
+    } else {
+      s.cfg.fast_ols = 1;
+    }
+  };
+  handlers["--LMS-F32"] = [](Shell& s, auto val) {
+    if(val == "NO" || val == "0") {
+      s.cfg.lms_f32 = 0;
+    } else {
+      s.cfg.lms_f32 = 1;
+    }
+  };
+  handlers["--FRAME-CRC"] = [](Shell& s, auto val) {
+    if(val == "NO" || val == "0") {
+      s.cfg.frame_crc = 0;
+    } else {
+      s.cfg.frame_crc = 1;
+    }
+  };
   handlers["--ZERO-MEAN"] = [](Shell& s, auto val) {
     if(val == "NO" || val == "0") {
       s.cfg.zero_mean = 0;
@@ -163,6 +208,7 @@ Shell::CreateParamHandlers() {
 
 std::int32_t Shell::Parse(std::span<const char*> args) {
   if(args.size() < 2) {
+    SACInfo();
     std::cout << SACHelp;
     return 1;
   }
@@ -194,6 +240,11 @@ std::int32_t Shell::Parse(std::span<const char*> args) {
       }
     }
   }
+  // audio data goes to stdout, keep it clean of log output
+  if(soutputfile == AudioFileBase::StdStreamName) {
+    AudioFileBase::DetachStdOut();
+  }
+
   // configure opt method
   if(cfg.ocfg.optimize_search == FrameCoder::SearchMethod::DDS) {
     cfg.ocfg.dds_cfg.nfunc_max = cfg.ocfg.maxnfunc;
@@ -225,6 +276,9 @@ std::int32_t Shell::Process() {
     case Lib::Mode::LISTFULL:
       if(!Lib::List(sinputfile, cfg, true)) { return 1; }
       break;
+    case Lib::Mode::TEST:
+      if(!Lib::Test(sinputfile, cfg)) { return 1; }
+      break;
   }
 
   myTimer.stop();
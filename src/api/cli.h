@@ -13,9 +13,13 @@ constexpr std::string_view SACHelp =
   "    --normal|high|veryhigh|extrahigh compression (def=normal)\n"
   "    --best            you asked for it\n\n"
   "  --decode            decode input.sac to output.wav\n"
+  "    --start=n         first sample to decode (def=0)\n"
+  "    --end=n           decode up to sample n (def=eof)\n"
+  "  --test              verify input.sac without writing output\n"
   "  --list              list info about input.sac\n"
   "  --listfull          verbose info about input\n"
-  "  --verbose           verbose output\n\n"
+  "  --verbose           verbose output\n"
+  "  use '-' as input/output to read from stdin or write to stdout\n\n"
   "  supported types: 1-16 bit, mono/stereo pcm\n"
   "  advanced options    (automatically set)\n"
   "   --optimize=#       frame-based optimization\n"
@@ -24,11 +28,18 @@ constexpr std::string_view SACHelp =
   "   --opt-cfg=#        configure optimization method\n"
   "     de|dds,nt,s      nt=num threads,s=search radius (def=0.2)\n"
   "   --opt-reset        reset opt params at frame boundaries\n"
-  "   --mt-mode=n        multi-threading level n=[0-2]\n"
+  "   --opt-warm         evaluate from the state before the opt window,\n"
+  "                      keeps the predictor structure fixed\n"
+  "   --mt-mode=n        multi-threading level n=[0-3]\n"
+  "   --frame-threads=n  code n frames in parallel (def=1)\n"
   "   --zero-mean        zero-mean input\n"
   "   --adapt-block      adaptive frame splitting\n"
   "   --framelen=n       def=20 seconds\n"
-  "   --sparse-pcm       enable pcm modelling\n";
+  "   --sparse-pcm       enable pcm modelling\n"
+  "   --fast-ols         O(n^2) ols solver, faster but weaker\n"
+  "   --lms-f32          single precision lms cascade\n"
+  "   --seek-table       append frame index (def=1)\n"
+  "   --frame-crc        store a crc32c per frame (def=1)\n";
 
 class Shell {
 public:
@@ -10,7 +10,8 @@ namespace Lib {
     ENCODE,
     DECODE,
     LIST,
-    LISTFULL
+    LISTFULL,
+    TEST
   };
 
   std::string CostStr(FrameCoder::SearchCost cost_func);
@@ -27,5 +28,7 @@ namespace Lib {
     FrameCoder::tsac_cfg& config
   );
   std::expected<void, AudioFileErr::Err>
+  Test(const std::string& input, FrameCoder::tsac_cfg& config);
+  std::expected<void, AudioFileErr::Err>
   List(const std::string& input, FrameCoder::tsac_cfg& config, bool full);
 } // namespace Lib
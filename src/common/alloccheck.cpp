@@ -0,0 +1,63 @@
+#include "alloccheck.h"
+
+#ifdef SAC_ALLOC_CHECK
+
+  #include <new>
+
+namespace {
+  thread_local std::size_t num_allocs = 0;
+
+  void* aligned_malloc(std::size_t size, std::size_t align) {
+  #ifdef _WIN32
+    return _aligned_malloc(size, align);
+  #else
+    // aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(align, (size + align - 1) / align * align);
+  #endif
+  }
+
+  void aligned_free(void* ptr) {
+  #ifdef _WIN32
+    _aligned_free(ptr);
+  #else
+    std::free(ptr);
+  #endif
+  }
+} // namespace
+
+std::size_t AllocCheck::Count() { return num_allocs; }
+
+// the array and nothrow forms forward to these by default
+void* operator new(std::size_t size) {
+  num_allocs++;
+  if(void* ptr = std::malloc(size != 0 ? size : 1)) { return ptr; }
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+  num_allocs++;
+  if(void* ptr = aligned_malloc(
+       size != 0 ? size : 1, static_cast<std::size_t>(align)
+     )) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t /*unused*/) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t /*unused*/) noexcept {
+  aligned_free(ptr);
+}
+
+void operator delete(
+  void* ptr, std::size_t /*unused*/, std::align_val_t /*unused*/
+) noexcept {
+  aligned_free(ptr);
+}
+
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+// debug check for heap allocations in hot paths, build with -DSAC_ALLOC_CHECK
+// operator new is replaced in alloccheck.cpp and counts per thread
+namespace AllocCheck {
+#ifdef SAC_ALLOC_CHECK
+  // number of allocations made by the calling thread
+  std::size_t Count();
+
+  // aborts if the enclosing scope allocated
+  class Scope {
+  public:
+    explicit Scope(const char* name): name(name), start(Count()) {}
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope() {
+      const std::size_t n = Count() - start;
+      if(n != 0) {
+        std::fprintf(stderr, "alloc check: %zu allocation(s) in %s\n", n, name);
+        std::abort();
+      }
+    }
+
+  private:
+    const char* name;
+    std::size_t start;
+  };
+#else
+  class Scope {
+  public:
+    explicit Scope(const char* /*unused*/) {}
+  };
+#endif
+} // namespace AllocCheck
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#if defined(__SSE4_2__)
+  #include <immintrin.h>
+#endif
+
+// crc-32c (castagnoli), uses the sse4.2 crc32 instruction when available
+namespace CRC32C {
+  constexpr std::uint32_t POLY = 0x82f63b78; // reflected
+
+  constexpr std::array<std::uint32_t, 256> make_table() {
+    std::array<std::uint32_t, 256> table{};
+    for(std::uint32_t i = 0; i < 256; i++) {
+      std::uint32_t crc = i;
+      for(std::int32_t k = 0; k < 8; k++) {
+        crc = (crc & 1U) != 0 ? (crc >> 1U) ^ POLY : crc >> 1U;
+      }
+      table[i] = crc;
+    }
+    return table;
+  }
+
+  inline constexpr std::array<std::uint32_t, 256> table = make_table();
+
+  inline std::uint32_t
+  Update(std::uint32_t crc, std::span<const std::uint8_t> data) {
+    crc = ~crc;
+    std::size_t i = 0;
+#if defined(__SSE4_2__) && defined(__x86_64__)
+    for(; i + 8 <= data.size(); i += 8) {
+      std::uint64_t v = 0;
+      std::memcpy(&v, data.data() + i, 8);
+      crc = static_cast<std::uint32_t>(_mm_crc32_u64(crc, v));
+    }
+#endif
+    for(; i < data.size(); i++) {
+      crc = table[(crc ^ data[i]) & 0xffU] ^ (crc >> 8U);
+    }
+    return ~crc;
+  }
+
+  // samples as 32-bit little-endian words
+  inline std::uint32_t Samples(std::span<const std::int32_t> samples) {
+    return Update(
+      0, std::span<const std::uint8_t>(
+           reinterpret_cast<const std::uint8_t*>(samples.data()),
+           samples.size_bytes()
+         )
+    );
+  }
+} // namespace CRC32C
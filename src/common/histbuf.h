@@ -25,6 +25,8 @@ public:
 
   const T* data() const { return buf.data() + pos; }
 
+  template<class Archive> void Checkpoint(Archive& ar) { ar(pos, buf); }
+
 private:
   std::size_t n, pos{0};
   std::vector<T, align_alloc<T>> buf;
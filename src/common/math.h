@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../global.h"
+#include "alignbuf.h"
 
 #include <cassert>
 #include <cstddef>
@@ -16,48 +17,113 @@ namespace MathUtils {
   public:
     static constexpr double ftol = 1E-8;
 
-    explicit Cholesky(std::int32_t n): n(n), G(n, vec1D(n)) {}
+    // rows are padded to a multiple of 64 bytes
+    static constexpr std::int32_t PaddedStride(std::int32_t n) {
+      return (n + 7) & ~7;
+    }
+
+    explicit Cholesky(std::int32_t n):
+      n(n),
+      stride(PaddedStride(n)),
+      G(static_cast<std::size_t>(n) * stride) {}
 
     std::int32_t Factor(const vec2D& matrix, const double nu) {
       for(std::int32_t i = 0; i < n; i++) { // copy lower triangular matrix
-        std::copy_n(begin(matrix[i]), i + 1, begin(G[i]));
+        std::copy_n(begin(matrix[i]), i + 1, &G[row(i)]);
       }
+      return Decompose(G.data(), nu);
+    }
 
+    // matrix in the padded row-major layout of G, only its lower triangle
+    // is read. the caller keeps accumulating into it, so the factor goes
+    // to G, read straight from matrix instead of a full copy first
+    // N > 0 fixes the order at compile time, it must equal n
+    template<std::int32_t N = 0>
+    std::int32_t Factor(span_cf64 matrix, const double nu) {
+      return Decompose<N>(matrix.data(), nu);
+    }
+
+    template<std::int32_t N = 0> void Solve(span_cf64 b, vec1D& x) {
+      const std::int32_t nn = order<N>();
+      const std::size_t st = row_stride<N>();
+      for(std::int32_t i = 0; i < nn; i++) {
+        const double* gi = &G[i * st];
+        double sum = b[i];
+        for(std::int32_t j = 0; j < i; j++) { sum -= (gi[j] * x[j]); }
+        x[i] = sum / gi[i];
+      }
+      for(std::int32_t i = nn - 1; i >= 0; i--) {
+        double sum = x[i];
+        for(std::int32_t j = i + 1; j < nn; j++) {
+          sum -= (G[j * st + i] * x[j]);
+        }
+        x[i] = sum / G[i * st + i];
+      }
+    }
+
+    // G * v with the lower triangular factor
+    vec1D MulLower(const vec1D& v) const {
+      vec1D v_out(n);
       for(std::int32_t i = 0; i < n; i++) {
+        const double* gi = &G[row(i)];
+        double sum = 0.0;
+        for(std::int32_t j = 0; j <= i; j++) { sum += gi[j] * v[j]; }
+        v_out[i] = sum;
+      }
+      return v_out;
+    }
+
+    std::int32_t n, stride;
+    std::vector<double, align_alloc<double>> G;
+
+  private:
+    std::size_t row(std::int32_t i) const {
+      return static_cast<std::size_t>(i) * stride;
+    }
+
+    template<std::int32_t N> std::int32_t order() const {
+      if constexpr(N > 0) {
+        return N;
+      } else {
+        return n;
+      }
+    }
+
+    template<std::int32_t N> std::size_t row_stride() const {
+      if constexpr(N > 0) {
+        return PaddedStride(N);
+      } else {
+        return stride;
+      }
+    }
+
+    // src may be G itself, every entry is read before it is overwritten
+    template<std::int32_t N = 0>
+    std::int32_t Decompose(const double* src, const double nu) {
+      const std::int32_t nn = order<N>();
+      const std::size_t st = row_stride<N>();
+      for(std::int32_t i = 0; i < nn; i++) {
+        const double* si = &src[i * st];
+        double* gi = &G[i * st];
         // off-diagonal
         for(std::int32_t j = 0; j < i; j++) {
-          double sum = G[i][j];
-          for(std::int32_t k = 0; k < j; k++) { sum -= (G[i][k] * G[j][k]); }
-          G[i][j] = sum / G[j][j];
+          const double* gj = &G[j * st];
+          double sum = si[j];
+          for(std::int32_t k = 0; k < j; k++) { sum -= (gi[k] * gj[k]); }
+          gi[j] = sum / gj[j];
         }
 
         // diagonal
-        double sum = G[i][i] + nu; // add regularization
-        for(std::int32_t k = 0; k < i; k++) { sum -= (G[i][k] * G[i][k]); }
+        double sum = si[i] + nu; // add regularization
+        for(std::int32_t k = 0; k < i; k++) { sum -= (gi[k] * gi[k]); }
         if(sum > ftol) {
-          G[i][i] = std::sqrt(sum);
+          gi[i] = std::sqrt(sum);
         } else {
           return 1;
         }
       }
       return 0;
     }
-
-    void Solve(const vec1D& b, vec1D& x) {
-      for(std::int32_t i = 0; i < n; i++) {
-        double sum = b[i];
-        for(std::int32_t j = 0; j < i; j++) { sum -= (G[i][j] * x[j]); }
-        x[i] = sum / G[i][i];
-      }
-      for(std::int32_t i = n - 1; i >= 0; i--) {
-        double sum = x[i];
-        for(std::int32_t j = i + 1; j < n; j++) { sum -= (G[j][i] * x[j]); }
-        x[i] = sum / G[i][i];
-      }
-    }
-
-    std::int32_t n;
-    vec2D G;
   };
 
   OPTIMIZE_ON
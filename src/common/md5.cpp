@@ -2,7 +2,9 @@
 
 #include <array>
 #include <cstddef>
+#include <mutex>
 #include <span>
+#include <stop_token>
 
 constexpr std::uint32_t MD5_A = 0x67452301;
 constexpr std::uint32_t MD5_B = 0xefcdab89;
@@ -206,3 +208,73 @@ void MD5::Step(
   buffer[2] += CC;
   buffer[3] += DD;
 }
+
+MD5::AsyncUpdater::AsyncUpdater(MD5Context& ctx, std::size_t maxqueue):
+  ctx(ctx),
+  maxqueue(maxqueue),
+  worker([this](const std::stop_token& stoken) { Run(stoken); }) {}
+
+MD5::AsyncUpdater::~AsyncUpdater() {
+  Wait();
+  worker.request_stop();
+}
+
+void MD5::AsyncUpdater::Update(std::span<const std::uint8_t> input) {
+  if(input.empty()) { return; }
+  std::unique_lock lock(mtx);
+  cv_done.wait(lock, [this] {
+    return queue.size() + reserved < maxqueue;
+  });
+  reserved++;
+  tblock block;
+  if(!freelist.empty()) {
+    block.buf = std::move(freelist.back());
+    freelist.pop_back();
+  }
+  // copy without the lock, the worker keeps hashing meanwhile
+  lock.unlock();
+  block.buf.assign(input.begin(), input.end());
+  block.data = block.buf; // moving the vector keeps its storage
+  lock.lock();
+  reserved--;
+  queue.push_back(std::move(block));
+  lock.unlock();
+  cv_work.notify_one();
+}
+
+void MD5::AsyncUpdater::UpdateView(std::span<const std::uint8_t> input) {
+  if(input.empty()) { return; }
+  std::unique_lock lock(mtx);
+  cv_done.wait(lock, [this] {
+    return queue.size() + reserved < maxqueue;
+  });
+  queue.push_back({{}, input});
+  lock.unlock();
+  cv_work.notify_one();
+}
+
+void MD5::AsyncUpdater::Wait() {
+  std::unique_lock lock(mtx);
+  cv_done.wait(lock, [this] {
+    return queue.empty() && reserved == 0 && !busy;
+  });
+}
+
+void MD5::AsyncUpdater::Run(const std::stop_token& stoken) {
+  std::unique_lock lock(mtx);
+  while(cv_work.wait(lock, stoken, [this] { return !queue.empty(); })) {
+    tblock block = std::move(queue.front());
+    queue.pop_front();
+    busy = true;
+    lock.unlock();
+
+    MD5::Update(&ctx, block.data, block.data.size());
+
+    lock.lock();
+    busy = false;
+    if(block.buf.capacity() != 0) {
+      freelist.push_back(std::move(block.buf));
+    }
+    cv_done.notify_all();
+  }
+}
@@ -1,9 +1,14 @@
 #pragma once
 
 #include <array>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <mutex>
 #include <span>
+#include <thread>
+#include <vector>
 
 namespace MD5 {
   struct MD5Context {
@@ -25,4 +30,39 @@ namespace MD5 {
   void Step(
     std::array<std::uint32_t, 4>& buffer, std::array<std::uint32_t, 16>& input
   );
+
+  // hashes into ctx on a worker thread
+  // Update copies the data into a queue of at most maxqueue buffers and
+  // only blocks if the worker falls that far behind. UpdateView queues the
+  // span itself, the data has to stay valid until Wait returns
+  class AsyncUpdater {
+  public:
+    explicit AsyncUpdater(MD5Context& ctx, std::size_t maxqueue = 4);
+    AsyncUpdater(const AsyncUpdater&) = delete;
+    AsyncUpdater& operator=(const AsyncUpdater&) = delete;
+    ~AsyncUpdater();
+
+    void Update(std::span<const std::uint8_t> input);
+    void UpdateView(std::span<const std::uint8_t> input);
+    void Wait(); // returns once all queued data is hashed
+
+  private:
+    // data points into buf for copied input, buf is empty for views
+    struct tblock {
+      std::vector<std::uint8_t> buf;
+      std::span<const std::uint8_t> data;
+    };
+
+    void Run(const std::stop_token& stoken);
+
+    MD5Context& ctx;
+    std::size_t maxqueue;
+    std::deque<tblock> queue;
+    std::vector<std::vector<std::uint8_t>> freelist;
+    std::size_t reserved{0}; // queue slots of copies in progress
+    bool busy{false};
+    std::mutex mtx;
+    std::condition_variable_any cv_work, cv_done;
+    std::jthread worker; // last member, started after everything else
+  };
 } // namespace MD5
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// binary snapshots of adaptive model state
+// a class lists its adaptive members once in
+//   template<class Archive> void Checkpoint(Archive& ar) { ar(x, w, ...); }
+// which serves both directions. parameters fixed at construction are not
+// part of a snapshot, it only loads into an object of the same structure.
+// snapshots are native endian and meant for use within one process
+namespace State {
+  template<typename T, typename A>
+  concept Checkpointable = requires(T& t, A& ar) { t.Checkpoint(ar); };
+
+  class Writer {
+  public:
+    explicit Writer(std::vector<std::uint8_t>& buf): buf(buf) {}
+
+    template<typename... Ts> void operator()(Ts&... vals) { (put(vals), ...); }
+    // structural value, a reader fails if it differs on its side
+    template<typename T> void check(T val) { put(val); }
+    bool ok() const { return true; }
+
+  private:
+    template<typename T>
+      requires std::is_arithmetic_v<T>
+    void put(T& val) {
+      put_bytes(&val, sizeof(T));
+    }
+    template<typename T>
+      requires Checkpointable<T, Writer>
+    void put(T& obj) {
+      obj.Checkpoint(*this);
+    }
+    template<typename T, typename Alloc> void put(std::vector<T, Alloc>& v) {
+      auto n = static_cast<std::uint64_t>(v.size());
+      put(n);
+      put_range(std::span<T>(v));
+    }
+    template<typename T, std::size_t N> void put(std::array<T, N>& v) {
+      put_range(std::span<T>(v));
+    }
+    template<typename T> void put_range(std::span<T> v) {
+      if constexpr(std::is_arithmetic_v<T>) {
+        put_bytes(v.data(), v.size_bytes());
+      } else {
+        for(auto& e : v) { put(e); }
+      }
+    }
+    void put_bytes(const void* src, std::size_t len) {
+      const auto* p = static_cast<const std::uint8_t*>(src);
+      buf.insert(buf.end(), p, p + len);
+    }
+
+    std::vector<std::uint8_t>& buf;
+  };
+
+  // with apply=false only the structure is checked and nothing is written,
+  // which lets a caller validate a snapshot before modifying the target
+  class Reader {
+  public:
+    explicit Reader(std::span<const std::uint8_t> buf, bool apply = true):
+      buf(buf), apply(apply) {}
+
+    template<typename... Ts> void operator()(Ts&... vals) { (get(vals), ...); }
+    template<typename T> void check(T val) {
+      T stored{};
+      get_bytes(&stored, sizeof(T), true);
+      if(stored != val) { ok_ = false; }
+    }
+    // true if the snapshot matched and was fully consumed
+    bool ok() const { return ok_ && pos == buf.size(); }
+
+  private:
+    template<typename T>
+      requires std::is_arithmetic_v<T>
+    void get(T& val) {
+      get_bytes(&val, sizeof(T));
+    }
+    template<typename T>
+      requires Checkpointable<T, Reader>
+    void get(T& obj) {
+      if(ok_) { obj.Checkpoint(*this); }
+    }
+    template<typename T, typename Alloc> void get(std::vector<T, Alloc>& v) {
+      check(static_cast<std::uint64_t>(v.size()));
+      get_range(std::span<T>(v));
+    }
+    template<typename T, std::size_t N> void get(std::array<T, N>& v) {
+      get_range(std::span<T>(v));
+    }
+    template<typename T> void get_range(std::span<T> v) {
+      if constexpr(std::is_arithmetic_v<T>) {
+        get_bytes(v.data(), v.size_bytes());
+      } else {
+        for(auto& e : v) { get(e); }
+      }
+    }
+    void get_bytes(void* dst, std::size_t len, bool always = false) {
+      if(!ok_ || buf.size() - pos < len) {
+        ok_ = false;
+        return;
+      }
+      if(apply || always) { std::memcpy(dst, buf.data() + pos, len); }
+      pos += len;
+    }
+
+    std::span<const std::uint8_t> buf;
+    std::size_t pos{0};
+    bool apply;
+    bool ok_{true};
+  };
+} // namespace State
@@ -29,6 +29,11 @@ namespace BitUtils {
     );
   }
 
+  std::uint64_t get64LH(const std::span<const std::uint8_t, 8> buf) {
+    return static_cast<std::uint64_t>(get32LH(buf.first<4>()))
+           + (static_cast<std::uint64_t>(get32LH(buf.last<4>())) << 32U);
+  }
+
   void put16LH(std::span<std::uint8_t, 2> buf, std::uint16_t val) {
     buf[0] = val & 0xffU;
     buf[1] = static_cast<uint8_t>(val >> 8U) & 0xffU;
@@ -41,6 +46,11 @@ namespace BitUtils {
     buf[3] = (val >> 24U) & 0xffU;
   }
 
+  void put64LH(std::span<std::uint8_t, 8> buf, std::uint64_t val) {
+    put32LH(buf.first<4>(), static_cast<std::uint32_t>(val & 0xffffffffU));
+    put32LH(buf.last<4>(), static_cast<std::uint32_t>(val >> 32U));
+  }
+
   std::string U322Str(std::uint32_t val) {
     std::string s;
     for(std::int32_t i = 0; i < 4; i++) {
@@ -20,6 +20,8 @@ public:
 
   void Update(double val) { sum = alpha * sum + (1. - alpha) * val; }
 
+  template<class Archive> void Checkpoint(Archive& ar) { ar(sum); }
+
   double sum{0.0};
 
 private:
@@ -33,6 +35,8 @@ public:
 
   void Update(double val) { sum = alpha * sum + val; }
 
+  template<class Archive> void Checkpoint(Archive& ar) { ar(sum); }
+
   double sum{0.0};
 
 private:
@@ -63,6 +67,8 @@ public:
     }
   }
 
+  template<class Archive> void Checkpoint(Archive& ar) { ar(power_alpha, sum); }
+
 protected:
   double alpha, power_alpha{1.0}, sum{0.0};
 };
@@ -86,6 +92,10 @@ public:
 
   auto get() { return std::pair{mean_, std::max(0.0, var_)}; }
 
+  template<class Archive> void Checkpoint(Archive& ar) {
+    ar(first_, mean_, var_);
+  }
+
 protected:
   double alpha_;
   bool first_{true};
@@ -279,8 +289,10 @@ namespace miscUtils {
 namespace BitUtils {
   std::uint32_t get32HL(std::span<const std::uint8_t, 4> buf);
   std::uint32_t get32LH(std::span<const std::uint8_t, 4> buf);
+  std::uint64_t get64LH(std::span<const std::uint8_t, 8> buf);
   std::uint16_t get16LH(std::span<const std::uint8_t, 2> buf);
   void put16LH(std::span<std::uint8_t, 2> buf, std::uint16_t val);
   void put32LH(std::span<std::uint8_t, 4> buf, std::uint32_t val);
+  void put64LH(std::span<std::uint8_t, 8> buf, std::uint64_t val);
   std::string U322Str(std::uint32_t val);
 } // namespace BitUtils
@@ -5,13 +5,28 @@
 #include <ios>
 #include <iostream>
 
+#ifdef _WIN32
+  #include <fcntl.h>
+  #include <io.h>
+#endif
+
+std::streambuf* AudioFileBase::stdout_buf = nullptr;
+
+void AudioFileBase::DetachStdOut() {
+  if(stdout_buf == nullptr) {
+    stdout_buf = std::cout.rdbuf();
+    std::cout.rdbuf(std::cerr.rdbuf());
+  }
+}
+
 // Read
 AudioFileBase::AudioFileBase():
   samplerate(0),
   bitspersample(0),
   numchannels(0),
   numsamples(0),
-  kbps(0) {}
+  kbps(0),
+  stream(false) {}
 
 AudioFile<AudioFileBase::Mode::Read>::AudioFile(const std::string& fname) {
   auto result = Open(fname);
@@ -25,6 +40,16 @@ AudioFile<AudioFileBase::Mode::Read>::AudioFile(const std::string& fname) {
 
 std::expected<void, AudioFileErr::Err>
 AudioFile<AudioFileBase::Mode::Read>::Open(const std::string& fname) {
+  if(fname == StdStreamName) { // attach to stdin, size unknown
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    static_cast<std::ios&>(file).rdbuf(std::cin.rdbuf());
+    stream = true;
+    filesize = -1;
+    return {};
+  }
+
   file.open(
     fname, static_cast<std::ios_base::openmode>(
              static_cast<std::uint8_t>(std::ios_base::in)
@@ -53,7 +78,8 @@ AudioFileBase::AudioFileBase(const AudioFileBase& file):
   bitspersample(file.getBitsPerSample()),
   numchannels(file.getNumChannels()),
   numsamples(file.getNumSamples()),
-  kbps(0) {}
+  kbps(0),
+  stream(false) {}
 
 AudioFile<AudioFileBase::Mode::Write>::AudioFile(
   const std::string& fname, const AudioFileBase& file
@@ -70,6 +96,17 @@ AudioFile<AudioFileBase::Mode::Write>::AudioFile(
 
 std::expected<void, AudioFileErr::Err>
 AudioFile<AudioFileBase::Mode::Write>::Open(const std::string& fname) {
+  if(fname == StdStreamName) {
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    static_cast<std::ios&>(file).rdbuf(
+      stdout_buf != nullptr ? stdout_buf : std::cout.rdbuf()
+    );
+    stream = true;
+    return {};
+  }
+
   file.open(
     fname, static_cast<std::ios_base::openmode>(
              static_cast<std::uint8_t>(std::ios_base::out)
@@ -92,6 +129,7 @@ void AudioFile<AudioFileBase::Mode::Write>::Write(
 
 // Share
 std::streampos AudioFileBase::readFileSize() {
+  if(stream) { return -1; }
   std::streampos oldpos = file.tellg();
   file.seekg(0, std::ios_base::end);
   std::streampos fsize = file.tellg();
@@ -4,7 +4,9 @@
 #include <expected>
 #include <fstream>
 #include <stdexcept>
+#include <streambuf>
 #include <string>
+#include <string_view>
 #include <vector>
 
 class AudioFileErr: std::runtime_error {
@@ -40,8 +42,17 @@ public:
   AudioFileBase& operator=(AudioFileBase&& file) noexcept = default;
   ~AudioFileBase() = default;
 
+  // "-" reads from stdin or writes to stdout
+  static constexpr std::string_view StdStreamName = "-";
+
+  // route std::cout to std::cerr, keeping stdout free for audio data
+  static void DetachStdOut();
+
   std::streampos getFileSize() const { return filesize; };
 
+  // not seekable, file size unknown
+  bool isStream() const { return stream; };
+
   std::int32_t getNumChannels() const { return numchannels; };
 
   std::int32_t getSampleRate() const { return samplerate; };
@@ -60,6 +71,9 @@ public:
 protected:
   std::streampos filesize;
   std::int32_t samplerate, bitspersample, numchannels, numsamples, kbps;
+  bool stream;
+
+  static std::streambuf* stdout_buf;
 };
 
 template<AudioFileBase::Mode> class AudioFile: public AudioFileBase {};
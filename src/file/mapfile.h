@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+  #define SAC_HAVE_MMAP
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+// read-only memory mapping of a whole file
+// Map() fails on platforms without mmap, callers fall back to iostreams
+class MappedFile {
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile() { Unmap(); }
+
+  bool Map(const std::string& fname) {
+#ifdef SAC_HAVE_MMAP
+    Unmap();
+    const int fd = ::open(fname.c_str(), O_RDONLY);
+    if(fd < 0) { return false; }
+    struct stat st{};
+    if(::fstat(fd, &st) != 0 || st.st_size <= 0) {
+      ::close(fd);
+      return false;
+    }
+    void* ptr = ::mmap(
+      nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE,
+      fd, 0
+    );
+    ::close(fd); // the mapping keeps its own reference
+    if(ptr == MAP_FAILED) { return false; }
+    data_ = static_cast<const std::uint8_t*>(ptr);
+    size_ = static_cast<std::size_t>(st.st_size);
+    return true;
+#else
+    (void)fname;
+    return false;
+#endif
+  }
+
+  // hint sequential access, pages behind the reader can be dropped early
+  void AdviseSequential() const {
+#ifdef SAC_HAVE_MMAP
+    if(data_ != nullptr) {
+      ::madvise(const_cast<std::uint8_t*>(data_), size_, MADV_SEQUENTIAL);
+    }
+#endif
+  }
+
+  void Unmap() {
+#ifdef SAC_HAVE_MMAP
+    if(data_ != nullptr) {
+      ::munmap(const_cast<std::uint8_t*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  bool IsMapped() const { return data_ != nullptr; }
+
+  const std::uint8_t* Data() const { return data_; }
+
+  std::size_t Size() const { return size_; }
+
+private:
+  const std::uint8_t* data_ = nullptr;
+  std::size_t size_ = 0;
+};
@@ -0,0 +1,596 @@
+#include "pcm.h"
+
+#include <cstddef>
+#include <cstring>
+#include <immintrin.h>
+
+namespace {
+  // simd kernels return the number of samples (per channel) processed,
+  // the scalar loops below finish the remainder
+#if defined(__AVX2__)
+  inline __m256i mask24() { // first 24 bytes
+    return _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0);
+  }
+
+  // 4x 3 bytes -> 4x int32 in the upper 24 bits of every dword
+  inline __m256i expand24(__m256i v) {
+    const __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    const __m256i shuf = _mm256_setr_epi8(
+      -128, 0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128, 0, 1,
+      2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11
+    );
+    v = _mm256_permutevar8x32_epi32(v, idx);
+    return _mm256_shuffle_epi8(v, shuf);
+  }
+
+  // 8x int32 -> 24 packed bytes in the low 6 dwords
+  inline __m256i compress24(__m256i v) {
+    const __m256i shuf = _mm256_setr_epi8(
+      0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128, 0, 1, 2,
+      4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128
+    );
+    const __m256i idx = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+    v = _mm256_shuffle_epi8(v, shuf);
+    return _mm256_permutevar8x32_epi32(v, idx);
+  }
+
+  // low 16 bit of 8x int32 -> 16 bytes
+  inline __m128i compress16(__m256i v) {
+    const __m256i shuf = _mm256_setr_epi8(
+      0, 1, 4, 5, 8, 9, 12, 13, -128, -128, -128, -128, -128, -128, -128, -128,
+      0, 1, 4, 5, 8, 9, 12, 13, -128, -128, -128, -128, -128, -128, -128, -128
+    );
+    v = _mm256_shuffle_epi8(v, shuf);
+    v = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm256_castsi256_si128(v);
+  }
+
+  std::int32_t
+  unpack8_mono(const std::uint8_t* src, std::int32_t* d0, std::int32_t n) {
+    const __m256i bias = _mm256_set1_epi32(128);
+    std::int32_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+      __m256i v = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i))
+      );
+      _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(d0 + i), _mm256_sub_epi32(v, bias)
+      );
+    }
+    return i;
+  }
+
+  std::int32_t unpack8_stereo(
+    const std::uint8_t* src, std::int32_t* d0, std::int32_t* d1, std::int32_t n
+  ) {
+    const __m256i bias = _mm256_set1_epi32(128);
+    const __m256i lo16 = _mm256_set1_epi32(0xffff);
+    std::int32_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+      __m256i v = _mm256_cvtepu8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i))
+      );
+      __m256i l = _mm256_and_si256(v, lo16);
+      __m256i r = _mm256_srli_epi32(v, 16);
+      _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(d0 + i), _mm256_sub_epi32(l, bias)
+      );
+      _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(d1 + i), _mm256_sub_epi32(r, bias)
+      );
+    }
+    return i;
+  }
+
+  std::int32_t
+  unpack16_mono(const std::uint8_t* src, std::int32_t* d0, std::int32_t n) {
+    std::int32_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+      __m256i v = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i))
+      );
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(d0 + i), v);
+    }
+    return i;
+  }
+
+  std::int32_t unpack16_stereo(
+    const std::uint8_t* src, std::int32_t* d0, std::int32_t* d1, std::int32_t n
+  ) {
+    std::int32_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+      __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * i));
+      __m256i l = _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+      __m256i r = _mm256_srai_epi32(v, 16);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(d0 + i), l);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(d1 + i), r);
+    }
+    return i;
+  }
+
+  std::int32_t
+  unpack24_mono(const std::uint8_t* src, std::int32_t* d0, std::int32_t n) {
+    const __m256i mask = mask24();
+    std::int32_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+      __m256i v = _mm256_maskload_epi32(
+        reinterpret_cast<const int*>(src + 3 * i), mask
+      );
+      v = _mm256_srai_epi32(expand24(v), 8);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(d0 + i), v);
+    }
+    return i;
+  }
+
+  std::int32_t unpack24_stereo(
+    const std::uint8_t* src, std::int32_t* d0, std::int32_t* d1, std::int32_t n
+  ) {
+    const __m256i mask = mask24();
+    const __m256i deinterleave = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    std::int32_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+      __m256i v = _mm256_maskload_epi32(
+        reinterpret_cast<const int*>(src + 6 * i), mask
+      );
+      v = _mm256_srai_epi32(expand24(v), 8);
+      v = _mm256_permutevar8x32_epi32(v, deinterleave);
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(d0 + i), _mm256_castsi256_si128(v)
+      );
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(d1 + i), _mm256_extracti128_si256(v, 1)
+      );
+    }
+    return i;
+  }
+
+  std::int32_t
+  pack8_mono(const std::int32_t* s0, std::uint8_t* dst, std::int32_t n) {
+    const __m256i bias = _mm256_set1_epi32(128);
+    const __m256i shuf = _mm256_setr_epi8(
+      0, 4, 8, 12, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128,
+      -128, -128, 0, 4, 8, 12, -128, -128, -128, -128, -128, -128, -128, -128,
+      -128, -128, -128, -128
+    );
+    const __m256i idx = _mm256_setr_epi32(0, 4, 1, 2, 3, 5, 6, 7);
+    std::int32_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+      __m256i v = _mm256_add_epi32(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0 + i)), bias
+      );
+      v = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, shuf), idx);
+      _mm_storel_epi64(
+        reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(v)
+      );
+    }
+    return i;
+  }
+
+  std::int32_t pack8_stereo(
+    const std::int32_t* s0, const std::int32_t* s1, std::uint8_t* dst,
+    std::int32_t n
+  ) {
+    const __m256i bias = _mm256_set1_epi32(128);
+    const __m256i lo8 = _mm256_set1_epi32(0xff);
+    std::int32_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+      __m256i l = _mm256_add_epi32(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0 + i)), bias
+      );
+      __m256i r = _mm256_add_epi32(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + i)), bias
+      );
+      __m256i v = _mm256_or_si256(
+        _mm256_and_si256(l, lo8), _mm256_slli_epi32(_mm256_and_si256(r, lo8), 8)
+      );
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), compress16(v));
+    }
+    return i;
+  }
+
+  std::int32_t
+  pack16_mono(const std::int32_t* s0, std::uint8_t* dst, std::int32_t n) {
+    std::int32_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0 + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), compress16(v));
+    }
+    return i;
+  }
+
+  std::int32_t pack16_stereo(
+    const std::int32_t* s0, const std::int32_t* s1, std::uint8_t* dst,
+    std::int32_t n
+  ) {
+    const __m256i lo16 = _mm256_set1_epi32(0xffff);
+    std::int32_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+      __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0 + i));
+      __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + i));
+      __m256i v =
+        _mm256_or_si256(_mm256_and_si256(l, lo16), _mm256_slli_epi32(r, 16));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4 * i), v);
+    }
+    return i;
+  }
+
+  std::int32_t
+  pack24_mono(const std::int32_t* s0, std::uint8_t* dst, std::int32_t n) {
+    const __m256i mask = mask24();
+    std::int32_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0 + i));
+      _mm256_maskstore_epi32(
+        reinterpret_cast<int*>(dst + 3 * i), mask, compress24(v)
+      );
+    }
+    return i;
+  }
+
+  std::int32_t pack24_stereo(
+    const std::int32_t* s0, const std::int32_t* s1, std::uint8_t* dst,
+    std::int32_t n
+  ) {
+    const __m256i mask = mask24();
+    std::int32_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+      __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + i));
+      __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + i));
+      __m256i v =
+        _mm256_set_m128i(_mm_unpackhi_epi32(l, r), _mm_unpacklo_epi32(l, r));
+      _mm256_maskstore_epi32(
+        reinterpret_cast<int*>(dst + 6 * i), mask, compress24(v)
+      );
+    }
+    return i;
+  }
+#elif defined(__SSE4_1__)
+  std::int32_t
+  unpack8_mono(const std::uint8_t* src, std::int32_t* d0, std::int32_t n) {
+    const __m128i bias = _mm_set1_epi32(128);
+    std::int32_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+      std::int32_t x = 0;
+      std::memcpy(&x, src + i, 4);
+      __m128i v = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(x));
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(d0 + i), _mm_sub_epi32(v, bias)
+      );
+    }
+    return i;
+  }
+
+  std::int32_t unpack8_stereo(
+    const std::uint8_t* src, std::int32_t* d0, std::int32_t* d1, std::int32_t n
+  ) {
+    const __m128i bias = _mm_set1_epi32(128);
+    const __m128i lo16 = _mm_set1_epi32(0xffff);
+    std::int32_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+      __m128i v = _mm_cvtepu8_epi16(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 2 * i))
+      );
+      __m128i l = _mm_and_si128(v, lo16);
+      __m128i r = _mm_srli_epi32(v, 16);
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(d0 + i), _mm_sub_epi32(l, bias)
+      );
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(d1 + i), _mm_sub_epi32(r, bias)
+      );
+    }
+    return i;
+  }
+
+  std::int32_t
+  unpack16_mono(const std::uint8_t* src, std::int32_t* d0, std::int32_t n) {
+    std::int32_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+      __m128i v = _mm_cvtepi16_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 2 * i))
+      );
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(d0 + i), v);
+    }
+    return i;
+  }
+
+  std::int32_t unpack16_stereo(
+    const std::uint8_t* src, std::int32_t* d0, std::int32_t* d1, std::int32_t n
+  ) {
+    std::int32_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+      __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+      __m128i l = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+      __m128i r = _mm_srai_epi32(v, 16);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(d0 + i), l);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(d1 + i), r);
+    }
+    return i;
+  }
+
+  std::int32_t unpack24_mono(const std::uint8_t*, std::int32_t*, std::int32_t) {
+    return 0;
+  }
+
+  std::int32_t unpack24_stereo(
+    const std::uint8_t*, std::int32_t*, std::int32_t*, std::int32_t
+  ) {
+    return 0;
+  }
+
+  std::int32_t
+  pack8_mono(const std::int32_t* s0, std::uint8_t* dst, std::int32_t n) {
+    const __m128i bias = _mm_set1_epi32(128);
+    const __m128i shuf = _mm_setr_epi8(
+      0, 4, 8, 12, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128,
+      -128, -128
+    );
+    std::int32_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+      __m128i v = _mm_add_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + i)), bias
+      );
+      std::int32_t x = _mm_cvtsi128_si32(_mm_shuffle_epi8(v, shuf));
+      std::memcpy(dst + i, &x, 4);
+    }
+    return i;
+  }
+
+  std::int32_t pack8_stereo(
+    const std::int32_t* s0, const std::int32_t* s1, std::uint8_t* dst,
+    std::int32_t n
+  ) {
+    const __m128i bias = _mm_set1_epi32(128);
+    const __m128i lo8 = _mm_set1_epi32(0xff);
+    const __m128i shuf = _mm_setr_epi8(
+      0, 1, 4, 5, 8, 9, 12, 13, -128, -128, -128, -128, -128, -128, -128, -128
+    );
+    std::int32_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+      __m128i l = _mm_add_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + i)), bias
+      );
+      __m128i r = _mm_add_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + i)), bias
+      );
+      __m128i v = _mm_or_si128(
+        _mm_and_si128(l, lo8), _mm_slli_epi32(_mm_and_si128(r, lo8), 8)
+      );
+      _mm_storel_epi64(
+        reinterpret_cast<__m128i*>(dst + 2 * i), _mm_shuffle_epi8(v, shuf)
+      );
+    }
+    return i;
+  }
+
+  std::int32_t
+  pack16_mono(const std::int32_t* s0, std::uint8_t* dst, std::int32_t n) {
+    const __m128i shuf = _mm_setr_epi8(
+      0, 1, 4, 5, 8, 9, 12, 13, -128, -128, -128, -128, -128, -128, -128, -128
+    );
+    std::int32_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + i));
+      _mm_storel_epi64(
+        reinterpret_cast<__m128i*>(dst + 2 * i), _mm_shuffle_epi8(v, shuf)
+      );
+    }
+    return i;
+  }
+
+  std::int32_t pack16_stereo(
+    const std::int32_t* s0, const std::int32_t* s1, std::uint8_t* dst,
+    std::int32_t n
+  ) {
+    const __m128i lo16 = _mm_set1_epi32(0xffff);
+    std::int32_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+      __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + i));
+      __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + i));
+      __m128i v = _mm_or_si128(_mm_and_si128(l, lo16), _mm_slli_epi32(r, 16));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * i), v);
+    }
+    return i;
+  }
+
+  std::int32_t pack24_mono(const std::int32_t*, std::uint8_t*, std::int32_t) {
+    return 0;
+  }
+
+  std::int32_t pack24_stereo(
+    const std::int32_t*, const std::int32_t*, std::uint8_t*, std::int32_t
+  ) {
+    return 0;
+  }
+#else
+  std::int32_t unpack8_mono(const std::uint8_t*, std::int32_t*, std::int32_t) {
+    return 0;
+  }
+
+  std::int32_t unpack8_stereo(
+    const std::uint8_t*, std::int32_t*, std::int32_t*, std::int32_t
+  ) {
+    return 0;
+  }
+
+  std::int32_t
+  unpack16_mono(const std::uint8_t*, std::int32_t*, std::int32_t) {
+    return 0;
+  }
+
+  std::int32_t unpack16_stereo(
+    const std::uint8_t*, std::int32_t*, std::int32_t*, std::int32_t
+  ) {
+    return 0;
+  }
+
+  std::int32_t
+  unpack24_mono(const std::uint8_t*, std::int32_t*, std::int32_t) {
+    return 0;
+  }
+
+  std::int32_t unpack24_stereo(
+    const std::uint8_t*, std::int32_t*, std::int32_t*, std::int32_t
+  ) {
+    return 0;
+  }
+
+  std::int32_t pack8_mono(const std::int32_t*, std::uint8_t*, std::int32_t) {
+    return 0;
+  }
+
+  std::int32_t pack8_stereo(
+    const std::int32_t*, const std::int32_t*, std::uint8_t*, std::int32_t
+  ) {
+    return 0;
+  }
+
+  std::int32_t pack16_mono(const std::int32_t*, std::uint8_t*, std::int32_t) {
+    return 0;
+  }
+
+  std::int32_t pack16_stereo(
+    const std::int32_t*, const std::int32_t*, std::uint8_t*, std::int32_t
+  ) {
+    return 0;
+  }
+
+  std::int32_t pack24_mono(const std::int32_t*, std::uint8_t*, std::int32_t) {
+    return 0;
+  }
+
+  std::int32_t pack24_stereo(
+    const std::int32_t*, const std::int32_t*, std::uint8_t*, std::int32_t
+  ) {
+    return 0;
+  }
+#endif
+} // namespace
+
+void PCM::Unpack(
+  std::span<const std::uint8_t> src,
+  std::vector<std::vector<std::int32_t>>& dst, std::int32_t numchannels,
+  std::int32_t csize, std::int32_t nsamples
+) {
+  const std::uint8_t* ptr = src.data();
+  std::int32_t i = 0;
+  if(numchannels == 1) {
+    std::int32_t* d0 = dst[0].data();
+    if(csize == 1) {
+      i = unpack8_mono(ptr, d0, nsamples);
+    } else if(csize == 2) {
+      i = unpack16_mono(ptr, d0, nsamples);
+    } else if(csize == 3) {
+      i = unpack24_mono(ptr, d0, nsamples);
+    }
+  } else if(numchannels == 2) {
+    std::int32_t* d0 = dst[0].data();
+    std::int32_t* d1 = dst[1].data();
+    if(csize == 1) {
+      i = unpack8_stereo(ptr, d0, d1, nsamples);
+    } else if(csize == 2) {
+      i = unpack16_stereo(ptr, d0, d1, nsamples);
+    } else if(csize == 3) {
+      i = unpack24_stereo(ptr, d0, d1, nsamples);
+    }
+  }
+
+  // remaining samples
+  std::size_t bufptr = static_cast<std::size_t>(i) * numchannels * csize;
+  if(csize == 1) {
+    for(; i < nsamples; i++) { // unpack samples
+      for(std::int32_t k = 0; k < numchannels; k++) {
+        std::uint8_t sample = ptr[bufptr];
+        bufptr += 1;
+        dst[k][i] = static_cast<std::int32_t>(sample) - 128;
+      }
+    }
+  } else if(csize == 2) {
+    for(; i < nsamples; i++) { // unpack samples
+      for(std::int32_t k = 0; k < numchannels; k++) {
+        auto sample = static_cast<std::int16_t>(
+          static_cast<std::uint16_t>(ptr[bufptr + 1] << 8U)
+          | static_cast<std::uint16_t>(ptr[bufptr])
+        );
+        bufptr += 2;
+        dst[k][i] = static_cast<std::int32_t>(sample);
+      }
+    }
+  } else if(csize == 3) {
+    for(; i < nsamples; i++) { // unpack samples
+      for(std::int32_t k = 0; k < numchannels; k++) {
+        std::uint32_t sample = 0;
+        sample = static_cast<std::uint32_t>(ptr[bufptr + 2]) << 24U;
+        sample |= static_cast<std::uint32_t>(ptr[bufptr + 1]) << 16U;
+        sample |= static_cast<std::uint32_t>(ptr[bufptr]) << 8U;
+        bufptr += 3;
+        dst[k][i] = static_cast<std::int32_t>(sample) >> 8;
+      }
+    }
+  }
+}
+
+void PCM::Pack(
+  const std::vector<std::vector<std::int32_t>>& src, std::int32_t first,
+  std::span<std::uint8_t> dst, std::int32_t numchannels, std::int32_t csize,
+  std::int32_t nsamples
+) {
+  std::uint8_t* ptr = dst.data();
+  std::int32_t i = 0;
+  if(numchannels == 1) {
+    const std::int32_t* s0 = src[0].data() + first;
+    if(csize == 1) {
+      i = pack8_mono(s0, ptr, nsamples);
+    } else if(csize == 2) {
+      i = pack16_mono(s0, ptr, nsamples);
+    } else if(csize == 3) {
+      i = pack24_mono(s0, ptr, nsamples);
+    }
+  } else if(numchannels == 2) {
+    const std::int32_t* s0 = src[0].data() + first;
+    const std::int32_t* s1 = src[1].data() + first;
+    if(csize == 1) {
+      i = pack8_stereo(s0, s1, ptr, nsamples);
+    } else if(csize == 2) {
+      i = pack16_stereo(s0, s1, ptr, nsamples);
+    } else if(csize == 3) {
+      i = pack24_stereo(s0, s1, ptr, nsamples);
+    }
+  }
+
+  // remaining samples
+  std::size_t bufptr = static_cast<std::size_t>(i) * numchannels * csize;
+  if(csize == 1) {
+    for(; i < nsamples; i++) { // pack samples
+      for(std::int32_t k = 0; k < numchannels; k++) {
+        ptr[bufptr] = static_cast<std::uint8_t>(
+          static_cast<std::uint32_t>(src[k][first + i] + 128) & 0xffU
+        );
+        bufptr += 1;
+      }
+    }
+  } else if(csize == 2) {
+    for(; i < nsamples; i++) { // pack samples
+      for(std::int32_t k = 0; k < numchannels; k++) {
+        auto sample = static_cast<std::int16_t>(src[k][first + i]);
+        ptr[bufptr] = static_cast<std::uint16_t>(sample) & 0xffU;
+        ptr[bufptr + 1] =
+          static_cast<std::uint16_t>(static_cast<std::uint16_t>(sample) >> 8U)
+          & 0xffU;
+        bufptr += 2;
+      }
+    }
+  } else if(csize == 3) {
+    for(; i < nsamples; i++) { // pack samples
+      for(std::int32_t k = 0; k < numchannels; k++) {
+        std::int32_t sample = src[k][first + i];
+        ptr[bufptr] = static_cast<std::uint32_t>(sample) & 0xffU;
+        ptr[bufptr + 1] = (static_cast<std::uint32_t>(sample) >> 8U) & 0xffU;
+        ptr[bufptr + 2] = (static_cast<std::uint32_t>(sample) >> 16U) & 0xffU;
+        bufptr += 3;
+      }
+    }
+  }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// conversion between interleaved little-endian pcm and planar samples
+// mono and stereo at 8/16/24 bit use simd kernels, everything else
+// and the loop tails are handled by scalar code
+namespace PCM {
+  // csize bytes per sample, 8 bit pcm is unsigned
+  void Unpack(
+    std::span<const std::uint8_t> src,
+    std::vector<std::vector<std::int32_t>>& dst, std::int32_t numchannels,
+    std::int32_t csize, std::int32_t nsamples
+  );
+
+  // packs nsamples starting at index first of every channel
+  void Pack(
+    const std::vector<std::vector<std::int32_t>>& src, std::int32_t first,
+    std::span<std::uint8_t> dst, std::int32_t numchannels,
+    std::int32_t csize, std::int32_t nsamples
+  );
+} // namespace PCM
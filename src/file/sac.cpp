@@ -24,7 +24,14 @@ Sac<AudioFileBase::Mode::Read>::ReadHeader() {
   std::array<std::uint8_t, 32> buf{};
   file.read(reinterpret_cast<char*>(buf.data()), 22);
 
-  if(buf[0] != 'S' || buf[1] != 'A' || buf[2] != 'C' || buf[3] != '2') {
+  if(buf[0] != 'S' || buf[1] != 'A' || buf[2] != 'C') {
+    return std::unexpected(AudioFileErr::Err::IllegalSac);
+  }
+  if(buf[3] != FORMAT_VERSION) {
+    std::cerr << "  error: unsupported .sac format version '"
+              << static_cast<char>(buf[3]) << "'";
+    if(buf[3] == '2') { std::cerr << ", written by sac 0.7.x"; }
+    std::cerr << '\n';
     return std::unexpected(AudioFileErr::Err::IllegalSac);
   }
 
@@ -37,6 +44,7 @@ Sac<AudioFileBase::Mode::Read>::ReadHeader() {
     BitUtils::get32LH(std::span<std::uint8_t, 4>(&buf[12], 4))
   );
   mcfg.max_framelen = buf[16];
+  mcfg.flags = buf[17];
   mcfg.metadatasize =
     BitUtils::get32LH(std::span<std::uint8_t, 4>(&buf[18], 4));
   Read(metadata, mcfg.metadatasize);
@@ -45,10 +53,97 @@ Sac<AudioFileBase::Mode::Read>::ReadHeader() {
   return {};
 }
 
+// locate the seek table via the trailer, leaves the file position untouched
+std::expected<void, AudioFileErr::Err>
+Sac<AudioFileBase::Mode::Read>::ReadSeekTable() {
+  if((mcfg.flags & FLAG_SEEKTABLE) == 0 || isStream()) {
+    return std::unexpected(AudioFileErr::Err::IllegalSac);
+  }
+  if(!seektable.empty()) { return {}; }
+
+  const std::streampos oldpos = file.tellg();
+  const auto filesize = static_cast<std::uint64_t>(getFileSize());
+  // frames start behind the header, its metadata and the md5
+  const std::uint64_t framespos =
+    22 + static_cast<std::uint64_t>(mcfg.metadatasize) + 16;
+  if(filesize < framespos + SEEKTABLE_TRAILER_SIZE) {
+    return std::unexpected(AudioFileErr::Err::IllegalSac);
+  }
+  const std::uint64_t trailerpos = filesize - SEEKTABLE_TRAILER_SIZE;
+
+  std::array<std::uint8_t, SEEKTABLE_TRAILER_SIZE> buf{};
+  file.seekg(static_cast<std::streamoff>(trailerpos));
+  file.read(reinterpret_cast<char*>(buf.data()), SEEKTABLE_TRAILER_SIZE);
+
+  const std::uint64_t tablepos =
+    BitUtils::get64LH(std::span<std::uint8_t, 8>(buf.data(), 8));
+  const std::uint32_t numframes =
+    BitUtils::get32LH(std::span<std::uint8_t, 4>(&buf[8], 4));
+  // bound tablepos and numframes by the file before using them, the
+  // trailer may be corrupt and its sums must not wrap
+  if(!file
+     || BitUtils::get32LH(std::span<std::uint8_t, 4>(&buf[12], 4))
+          != SEEKTABLE_TAG
+     || tablepos < framespos || tablepos > trailerpos
+     || numframes != (trailerpos - tablepos) / SEEKTABLE_ENTRY_SIZE
+     || (trailerpos - tablepos) % SEEKTABLE_ENTRY_SIZE != 0) {
+    file.clear();
+    file.seekg(oldpos);
+    return std::unexpected(AudioFileErr::Err::IllegalSac);
+  }
+
+  std::vector<std::uint8_t> tbuf;
+  file.seekg(static_cast<std::streamoff>(tablepos));
+  Read(tbuf, trailerpos - tablepos);
+  seektable.resize(numframes);
+  for(std::uint32_t i = 0; i < numframes; i++) {
+    std::span<std::uint8_t, SEEKTABLE_ENTRY_SIZE> entry(
+      &tbuf[static_cast<std::size_t>(i) * SEEKTABLE_ENTRY_SIZE],
+      SEEKTABLE_ENTRY_SIZE
+    );
+    seektable[i].pos = BitUtils::get64LH(entry.subspan<0, 8>());
+    seektable[i].first_sample = BitUtils::get32LH(entry.subspan<8, 4>());
+    seektable[i].numsamples = BitUtils::get32LH(entry.subspan<12, 4>());
+  }
+
+  // frames in file order inside the frame region, samples increasing
+  // and within the header sample count
+  bool valid = file.good();
+  for(std::uint32_t i = 0; valid && i < numframes; i++) {
+    const tframe_entry& e = seektable[i];
+    valid = e.pos >= framespos && e.pos < tablepos
+            && static_cast<std::uint64_t>(e.first_sample) + e.numsamples
+                 <= static_cast<std::uint32_t>(numsamples);
+    if(valid && i > 0) {
+      valid = e.pos > seektable[i - 1].pos
+              && e.first_sample > seektable[i - 1].first_sample;
+    }
+  }
+  file.clear();
+  file.seekg(oldpos);
+  if(!valid) {
+    seektable.clear();
+    return std::unexpected(AudioFileErr::Err::IllegalSac);
+  }
+  return {};
+}
+
 void Sac<AudioFileBase::Mode::Read>::ReadMD5(std::uint8_t digest[16]) {
   file.read(reinterpret_cast<char*>(digest), 16);
 }
 
+// trailing record of a streamed file, replaces numsamples and md5
+std::int32_t
+Sac<AudioFileBase::Mode::Read>::ReadEndRecord(std::uint8_t digest[16]) {
+  std::array<std::uint8_t, 4> buf{};
+  file.read(reinterpret_cast<char*>(buf.data()), 4);
+  numsamples = static_cast<std::int32_t>(
+    BitUtils::get32LH(std::span<std::uint8_t, 4>(buf.data(), 4))
+  );
+  ReadMD5(digest);
+  return numsamples;
+}
+
 // Write
 Sac<AudioFileBase::Mode::Write>::Sac(
   const std::string& fname, AudioFile<AudioFileBase::Mode::Read>& file
@@ -65,13 +160,13 @@ void Sac<AudioFileBase::Mode::Write>::WriteHeader(
   buf[0] = 'S';
   buf[1] = 'A';
   buf[2] = 'C';
-  buf[3] = '2';
+  buf[3] = FORMAT_VERSION;
   BitUtils::put16LH(std::span<std::uint8_t, 2>(&buf[4], 2), numchannels);
   BitUtils::put32LH(std::span<std::uint8_t, 4>(&buf[6], 4), samplerate);
   BitUtils::put16LH(std::span<std::uint8_t, 2>(&buf[10], 2), bitspersample);
   BitUtils::put32LH(std::span<std::uint8_t, 4>(&buf[12], 4), numsamples);
   buf[16] = mcfg.max_framelen;
-  buf[17] = 0;
+  buf[17] = mcfg.flags;
 
   // write wav meta data
   const std::uint32_t metadatasize = myChunks.GetMetaDataSize();
@@ -86,3 +181,59 @@ void Sac<AudioFileBase::Mode::Write>::WriteHeader(
 void Sac<AudioFileBase::Mode::Write>::WriteMD5(std::uint8_t digest[16]) {
   file.write(reinterpret_cast<char*>(digest), 16);
 }
+
+void Sac<AudioFileBase::Mode::Write>::AddSeekEntry(
+  std::uint64_t pos, std::uint32_t first_sample, std::uint32_t numsamples
+) {
+  seektable.push_back({pos, first_sample, numsamples});
+}
+
+// seek table followed by a fixed size trailer pointing to it
+void Sac<AudioFileBase::Mode::Write>::WriteSeekTable() {
+  const auto tablepos = static_cast<std::uint64_t>(file.tellp());
+  std::vector<std::uint8_t> buf(
+    seektable.size() * SEEKTABLE_ENTRY_SIZE + SEEKTABLE_TRAILER_SIZE
+  );
+  std::size_t ofs = 0;
+  for(const auto& entry: seektable) {
+    BitUtils::put64LH(std::span<std::uint8_t, 8>(&buf[ofs], 8), entry.pos);
+    BitUtils::put32LH(
+      std::span<std::uint8_t, 4>(&buf[ofs + 8], 4), entry.first_sample
+    );
+    BitUtils::put32LH(
+      std::span<std::uint8_t, 4>(&buf[ofs + 12], 4), entry.numsamples
+    );
+    ofs += SEEKTABLE_ENTRY_SIZE;
+  }
+  BitUtils::put64LH(std::span<std::uint8_t, 8>(&buf[ofs], 8), tablepos);
+  BitUtils::put32LH(
+    std::span<std::uint8_t, 4>(&buf[ofs + 8], 4),
+    static_cast<std::uint32_t>(seektable.size())
+  );
+  BitUtils::put32LH(
+    std::span<std::uint8_t, 4>(&buf[ofs + 12], 4), SEEKTABLE_TAG
+  );
+  Write(buf, buf.size());
+}
+
+// patch the sample count of the header, keeps the file position
+void Sac<AudioFileBase::Mode::Write>::WriteNumSamples(std::uint32_t nsamples) {
+  std::array<std::uint8_t, 4> buf{};
+  BitUtils::put32LH(buf, nsamples);
+  const std::streampos oldpos = file.tellp();
+  file.seekp(12);
+  file.write(reinterpret_cast<char*>(buf.data()), 4);
+  file.seekp(oldpos);
+  numsamples = static_cast<std::int32_t>(nsamples);
+}
+
+// empty frame as end marker, followed by the final numsamples and md5
+void Sac<AudioFileBase::Mode::Write>::WriteEndRecord(
+  std::uint32_t nsamples, std::uint8_t digest[16]
+) {
+  std::array<std::uint8_t, 8> buf{};
+  BitUtils::put32LH(std::span<std::uint8_t, 4>(buf.data(), 4), 0);
+  BitUtils::put32LH(std::span<std::uint8_t, 4>(&buf[4], 4), nsamples);
+  file.write(reinterpret_cast<char*>(buf.data()), 8);
+  WriteMD5(digest);
+}
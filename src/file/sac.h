@@ -7,8 +7,20 @@
 
 class SacBase {
 public:
+  // the magic is 'SAC' followed by the format version. version 3 added
+  // block flags 10-12 (crc, fast ols, f32 lms), which version 2 readers
+  // would ignore and silently decode wrong. it also changed the summation
+  // order of the nlms stages, version 2 files need sac 0.7.x to decode
+  static constexpr std::uint8_t FORMAT_VERSION = '3';
+
+  // header flags
+  static constexpr std::uint8_t FLAG_SEEKTABLE = 1U << 0U;
+  // frames end with an empty frame and an end record (numsamples, md5)
+  static constexpr std::uint8_t FLAG_STREAM = 1U << 1U;
+
   struct sac_cfg {
     std::uint8_t max_framelen = 0;
+    std::uint8_t flags = 0;
 
     std::uint32_t max_framesize = 0;
     std::uint32_t metadatasize = 0;
@@ -25,6 +37,20 @@ public:
   }
 
   std::vector<std::uint8_t> metadata;
+
+  // seek table entry: frame number -> file offset, first sample
+  struct tframe_entry {
+    std::uint64_t pos;
+    std::uint32_t first_sample, numsamples;
+  };
+
+  std::vector<tframe_entry> seektable;
+
+protected:
+  // trailer at the end of file: table offset, number of frames, tag
+  static constexpr std::int32_t SEEKTABLE_ENTRY_SIZE = 16;
+  static constexpr std::int32_t SEEKTABLE_TRAILER_SIZE = 16;
+  static constexpr std::uint32_t SEEKTABLE_TAG = 0x54434153; // 'SACT'
 };
 
 template<AudioFileBase::Mode> class Sac: public SacBase {};
@@ -37,7 +63,9 @@ public:
   explicit Sac(const std::string& fname);
 
   std::expected<void, AudioFileErr::Err> ReadHeader();
+  std::expected<void, AudioFileErr::Err> ReadSeekTable();
   void ReadMD5(std::uint8_t digest[16]);
+  std::int32_t ReadEndRecord(std::uint8_t digest[16]);
 };
 
 template<>
@@ -49,4 +77,10 @@ public:
 
   void WriteHeader(Wav<AudioFileBase::Mode::Read>& myWav);
   void WriteMD5(std::uint8_t digest[16]);
+  void AddSeekEntry(
+    std::uint64_t pos, std::uint32_t first_sample, std::uint32_t numsamples
+  );
+  void WriteSeekTable();
+  void WriteNumSamples(std::uint32_t nsamples);
+  void WriteEndRecord(std::uint32_t nsamples, std::uint8_t digest[16]);
 };
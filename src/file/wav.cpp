@@ -2,11 +2,13 @@
 
 #include "../common/utils.h"
 #include "file.h"
+#include "pcm.h"
 
 #include <algorithm>
 #include <array>
 #include <cstdint>
 #include <expected>
+#include <limits>
 #include <span>
 
 namespace {
@@ -85,6 +87,7 @@ std::size_t Chunks::UnpackMetaData(const std::vector<std::uint8_t>& data) {
 WavBase::WavBase(bool verbose):
   md5ctx(0),
   chunkpos(0),
+  md5updater(md5ctx),
   datapos(0),
   endofdata(0),
   byterate(0),
@@ -94,6 +97,11 @@ WavBase::WavBase(bool verbose):
   MD5::Init(&md5ctx);
 };
 
+void WavBase::FinalizeMD5() {
+  md5updater.Wait();
+  MD5::Finalize(&md5ctx);
+}
+
 // Read
 Wav<AudioFileBase::Mode::Read>::Wav(const std::string& fname, bool verbose) try:
   WavBase(verbose),
@@ -105,8 +113,16 @@ Wav<AudioFileBase::Mode::Read>::Wav(const std::string& fname, bool verbose) try:
 
     throw AudioFileErr(AudioFileErr::Err::IllegalWav);
   }
+  // read samples from a mapping if possible, saves the copy into filebuffer
+  if(!isStream() && mapfile.Map(fname)) {
+    mapfile.AdviseSequential();
+    mappos = static_cast<std::size_t>(datapos);
+  }
 } catch(AudioFileErr&) { throw; }
 
+// queued views point into the mapping, which is unmapped before the base
+Wav<AudioFileBase::Mode::Read>::~Wav() { md5updater.Wait(); }
+
 std::expected<void, AudioFileErr::Err>
 Wav<AudioFileBase::Mode::Read>::ReadHeader() {
   bool seektodatapos = true;
@@ -200,6 +216,17 @@ Wav<AudioFileBase::Mode::Read>::ReadHeader() {
         numsamples = static_cast<std::int32_t>(chunksize) / blockalign;
         samplesleft = numsamples;
 
+        // a pipe can't be rewound: the data chunk is the last one we see.
+        // writers of unknown length leave the size at 0 or 0xffffffff
+        if(isStream()) {
+          if(chunksize == 0 || chunksize == 0xffffffffU) {
+            numsamples = 0;
+            samplesleft = std::numeric_limits<std::int32_t>::max();
+          }
+          seektodatapos = false;
+          break;
+        }
+
         endofdata =
           datapos
           + std::streampos(word_align(static_cast<std::int32_t>(chunksize)));
@@ -228,7 +255,7 @@ Wav<AudioFileBase::Mode::Read>::ReadHeader() {
           std::span<const std::uint8_t>{vbuf.data(), readsize}
         );
       }
-      if(file.tellg() == getFileSize()) { break; }
+      if(!isStream() && file.tellg() == getFileSize()) { break; }
     }
   } else {
     return std::unexpected(AudioFileErr::Err::IllegalWav);
@@ -259,57 +286,55 @@ std::int32_t Wav<AudioFileBase::Mode::Read>::ReadSamples(
   // read samples
   samplestoread = std::min(samplestoread, samplesleft);
   std::int32_t bytestoread = samplestoread * blockalign;
-  file.read(reinterpret_cast<char*>(filebuffer.data()), bytestoread);
-  auto bytesread = static_cast<std::int32_t>(file.gcount());
-  std::int32_t samplesread = bytesread / blockalign;
+  std::int32_t samplesread = 0;
+  const std::uint8_t* src = filebuffer.data();
+  if(mapfile.IsMapped()) {
+    const std::size_t avail =
+      mapfile.Size() - std::min(mappos, mapfile.Size());
+    samplesread = static_cast<std::int32_t>(
+      std::min(static_cast<std::size_t>(bytestoread), avail) / blockalign
+    );
+    src = mapfile.Data() + mappos;
+    mappos += static_cast<std::size_t>(samplesread) * blockalign;
+  } else {
+    file.read(reinterpret_cast<char*>(filebuffer.data()), bytestoread);
+    auto bytesread = static_cast<std::int32_t>(file.gcount());
+    samplesread = bytesread / blockalign;
+  }
 
   samplesleft -= samplesread;
-  if(samplesread != samplestoread) { std::cerr << "warning: read over eof\n"; }
-
-  MD5::Update(&md5ctx, filebuffer, bytestoread);
-
-  const std::int32_t csize = blockalign / numchannels;
-  // decode samples
-  if(csize == 1) {
-    std::int32_t bufptr = 0;
-    for(std::int32_t i = 0; i < samplesread; i++) { // unpack samples
-      for(std::int32_t k = 0; k < numchannels; k++) {
-        std::uint8_t sample = filebuffer[bufptr];
-        bufptr += 1;
-        data[k][i] = static_cast<std::int32_t>(sample) - 128;
-      }
-    }
-  } else if(csize == 2) {
-    std::int32_t bufptr = 0;
-    for(std::int32_t i = 0; i < samplesread; i++) { // unpack samples
-      for(std::int32_t k = 0; k < numchannels; k++) {
-        auto sample = static_cast<std::int16_t>(
-          static_cast<std::uint16_t>(filebuffer[bufptr + 1] << 8U)
-          | static_cast<std::uint16_t>(filebuffer[bufptr])
-        );
-        bufptr += 2;
-        data[k][i] = static_cast<std::int32_t>(sample);
-      }
-    }
-  } else if(csize == 3) {
-    std::int32_t bufptr = 0;
-    for(std::int32_t i = 0; i < samplesread; i++) { // unpack samples
-      for(std::int32_t k = 0; k < numchannels; k++) {
-        std::uint32_t sample = 0;
-        sample = static_cast<std::uint32_t>(filebuffer[bufptr + 2]) << 24U;
-        sample |= static_cast<std::uint32_t>(filebuffer[bufptr + 1]) << 16U;
-        sample |= static_cast<std::uint32_t>(filebuffer[bufptr]) << 8U;
-        bufptr += 3;
-        data[k][i] = static_cast<std::int32_t>(sample >> 8U);
-      }
+  if(samplesread != samplestoread) {
+    if(numsamples == 0 && isStream()) { // end of a stream of unknown length
+      samplesleft = 0;
+    } else {
+      std::cerr << "warning: read over eof\n";
     }
+  }
+
+  const std::span<const std::uint8_t> bytes(
+    src, static_cast<std::size_t>(samplesread) * blockalign
+  );
+  // the mapping outlives the hashing, filebuffer is reused by the next read
+  if(mapfile.IsMapped()) {
+    md5updater.UpdateView(bytes);
   } else {
+    md5updater.Update(bytes);
+  }
+  const std::int32_t csize = blockalign / numchannels;
+  if(csize < 1 || csize > 3) {
     std::cerr << "error: unknown csize=" << csize << '\n';
   }
+  PCM::Unpack(bytes, data, numchannels, csize, samplesread);
 
   return samplesread;
 }
 
+// the real length of a piped wav is known after the last ReadSamples
+void Wav<AudioFileBase::Mode::Read>::SetNumSamples(std::int32_t nsamples) {
+  SetDataSize(nsamples);
+  numsamples = nsamples;
+}
+
 // Write
 Wav<AudioFileBase::Mode::Write>::Wav(
   const std::string& fname, AudioFile<AudioFileBase::Mode::Read>& file,
@@ -325,6 +350,31 @@ Wav<AudioFileBase::Mode::Write>::Wav(
   blockalign = numchannels * csize;
 } catch(AudioFileErr&) { throw; }
 
+// a piped wav can't be rewound to fix its header: writers of unknown length
+// leave 0 or 0xffffffff in the sizes, so the 'RIFF' size is recomputed from
+// the chunks instead of adjusted
+void WavBase::SetDataSize(std::int32_t nsamples) {
+  const std::int32_t datasize = nsamples * blockalign;
+  std::uint32_t riffsize = 4; // 'WAVE'
+  for(auto& chunk: myChunks.wavchunks) {
+    if(chunk.id == 0x61746164) {
+      chunk.csize = static_cast<std::uint32_t>(datasize);
+      riffsize += 8 + static_cast<std::uint32_t>(word_align(datasize));
+    } else if(chunk.id != 0x46464952) {
+      riffsize += 8 + static_cast<std::uint32_t>(chunk.data.size());
+    }
+  }
+  for(auto& chunk: myChunks.wavchunks) {
+    if(chunk.id == 0x46464952) { chunk.csize = riffsize; }
+  }
+}
+
+// trim the 'data' chunk to nsamples and fix up the 'RIFF' chunk size
+void Wav<AudioFileBase::Mode::Write>::SetNumSamples(std::int32_t nsamples) {
+  SetDataSize(nsamples);
+  numsamples = nsamples;
+}
+
 void Wav<AudioFileBase::Mode::Write>::WriteHeader() {
   std::array<std::uint8_t, 8> buf{};
   while(chunkpos < myChunks.GetNumChunks()) {
@@ -338,51 +388,28 @@ void Wav<AudioFileBase::Mode::Write>::WriteHeader() {
   }
 }
 
+// write the chunks up to 'data' again, e.g. after SetNumSamples.
+// the sizes are fixed width, keeps the file position
+void Wav<AudioFileBase::Mode::Write>::RewriteHeader() {
+  const std::streampos oldpos = file.tellp();
+  const std::size_t oldchunkpos = chunkpos;
+  file.seekp(0);
+  chunkpos = 0;
+  WriteHeader();
+  chunkpos = oldchunkpos;
+  file.seekp(oldpos);
+}
+
 std::int32_t Wav<AudioFileBase::Mode::Write>::WriteSamples(
   const std::vector<std::vector<std::int32_t>>& data,
-  std::int32_t samplestowrite
+  std::int32_t samplestowrite, std::int32_t first
 ) {
   const std::int32_t csize = blockalign / numchannels;
-  if(csize == 1) {
-    std::int32_t bufptr = 0;
-    for(std::int32_t i = 0; i < samplestowrite; i++) { // pack samples
-      for(std::int32_t k = 0; k < numchannels; k++) {
-        filebuffer[bufptr] = static_cast<std::uint8_t>(
-          static_cast<std::uint32_t>(data[k][i] + 128) & 0xffU
-        );
-        bufptr += 1;
-      }
-    }
-  } else if(csize == 2) {
-    std::int32_t bufptr = 0;
-    for(std::int32_t i = 0; i < samplestowrite; i++) { // pack samples
-      for(std::int32_t k = 0; k < numchannels; k++) {
-        auto sample = static_cast<std::int16_t>(data[k][i]);
-        filebuffer[bufptr] = static_cast<std::uint16_t>(sample) & 0xffU;
-        filebuffer[bufptr + 1] =
-          static_cast<std::uint16_t>(static_cast<std::uint16_t>(sample) >> 8U)
-          & 0xffU;
-        bufptr += 2;
-      }
-    }
-  } else if(csize == 3) {
-    std::int32_t bufptr = 0;
-    for(std::int32_t i = 0; i < samplestowrite; i++) { // pack samples
-      for(std::int32_t k = 0; k < numchannels; k++) {
-        std::int32_t sample = data[k][i];
-        filebuffer[bufptr] = static_cast<std::uint32_t>(sample) & 0xffU;
-        filebuffer[bufptr + 1] =
-          (static_cast<std::uint32_t>(sample) >> 8U) & 0xffU;
-        filebuffer[bufptr + 2] =
-          (static_cast<std::uint32_t>(sample) >> 16U) & 0xffU;
-        bufptr += 3;
-      }
-    }
-  }
+  PCM::Pack(data, first, filebuffer, numchannels, csize, samplestowrite);
   std::int32_t bytestowrite = samplestowrite * blockalign;
   file.write(reinterpret_cast<char*>(filebuffer.data()), bytestowrite);
 
-  MD5::Update(&md5ctx, filebuffer, bytestowrite);
+  md5updater.Update(std::span(filebuffer).first(bytestowrite));
   return bytestowrite;
 }
 
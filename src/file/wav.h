@@ -2,6 +2,7 @@
 
 #include "../common/md5.h"
 #include "file.h"
+#include "mapfile.h"
 
 #include <span>
 
@@ -50,12 +51,19 @@ public:
 
   Chunks& GetChunks() { return myChunks; };
 
+  // wait for the hashing thread and compute the final digest
+  void FinalizeMD5();
+
   MD5::MD5Context md5ctx;
 
 protected:
+  // set the 'data' chunk to nsamples and recompute the 'RIFF' chunk size
+  void SetDataSize(std::int32_t nsamples);
+
   Chunks myChunks;
   std::size_t chunkpos;
   std::vector<std::uint8_t> filebuffer;
+  MD5::AsyncUpdater md5updater;
   std::streampos datapos, endofdata;
   std::int32_t byterate, blockalign, samplesleft;
   bool verbose;
@@ -69,10 +77,16 @@ class Wav<AudioFileBase::Mode::Read>:
   public AudioFile<AudioFileBase::Mode::Read> {
 public:
   explicit Wav(const std::string& fname, bool verbose = false);
+  ~Wav();
   std::expected<void, AudioFileErr::Err> ReadHeader();
   std::int32_t ReadSamples(
     std::vector<std::vector<std::int32_t>>& data, std::int32_t samplestoread
   );
+  void SetNumSamples(std::int32_t nsamples);
+
+private:
+  MappedFile mapfile;
+  std::size_t mappos{0};
 };
 
 template<>
@@ -84,9 +98,11 @@ public:
     const std::string& fname, AudioFile<AudioFileBase::Mode::Read>& file,
     bool verbose = false
   );
+  void SetNumSamples(std::int32_t nsamples);
   void WriteHeader();
+  void RewriteHeader();
   std::int32_t WriteSamples(
     const std::vector<std::vector<std::int32_t>>& data,
-    std::int32_t samplestowrite
+    std::int32_t samplestowrite, std::int32_t first = 0
   );
 };
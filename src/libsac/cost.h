@@ -125,53 +125,22 @@ public:
   }
 };
 
-/*class StaticBitModel {
-  public:
-    StaticBitModel()
-    :pr(2,vec1D(PSCALE))
-    {
-      for (std::size_t i=1;i<PSCALE;i++)
-      {
-        double p1 = static_cast<double>(i)/static_cast<double>(PSCALE);
-        double t0 = -std::log2(1.0-p1);
-        double t1 = -std::log2(p1);
-        pr[0][i]= t0;
-        pr[1][i]= t1;
-      }
-      ResetCount();
-    }
-    void ResetCount(){nbits=0;};
-    void EncodeBitOne(std::uint32_t p1,std::int32_t bit)
-    {
-      nbits += pr[bit][p1];
-    }
-    auto EncodeP1_Func() {return [&](std::uint32_t p1,std::int32_t bit) {return
-EncodeBitOne(p1,bit);};}; // stupid C++
-
-  double nbits;
-  vec2D pr;
-};*/
 
 class CostBitplane: public CostFunction {
 public:
   CostBitplane() = default;
 
   double Calc(span_ci32 buf) const override {
-    std::size_t numsamples = buf.size();
-    std::vector<std::int32_t> ubuf(numsamples);
+    const std::size_t numsamples = buf.size();
     std::int32_t vmax = 1;
-    for(std::size_t i = 0; i < numsamples; i++) {
-      std::int32_t val = MathUtils::S2U(buf[i]);
-      vmax = std::max(val, vmax);
-      ubuf[i] = val;
-    }
-
-    BufIO iobuf;
-    RangeCoderSH rc(iobuf);
-    rc.Init();
-    BitplaneCoder bc_rc(std::ilogb(vmax), numsamples);
-    bc_rc.Encode(rc.encode_p1, ubuf.data());
-    rc.Stop();
-    return static_cast<double>(iobuf.GetBufPos());
+    for(const auto val: buf) { vmax = std::max(MathUtils::S2U(val), vmax); }
+
+    // estimated size in bytes, the input is staged in the pooled coder
+    auto bc = BitplaneCoderPool::Get(std::ilogb(vmax), numsamples);
+    auto& ubuf = bc->InputBuffer(numsamples);
+    std::ranges::transform(buf, ubuf.begin(), MathUtils::S2U);
+    BitCostSink sink;
+    bc->Encode(sink, ubuf.data());
+    return sink.Bytes();
   }
 };
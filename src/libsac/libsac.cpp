@@ -1,6 +1,9 @@
 #include "libsac.h"
 
+#include "../common/alloccheck.h"
+#include "../common/crc32c.h"
 #include "../common/timer.h"
+#include "../file/pcm.h"
 #include "../opt/cma.h"
 #include "../opt/dds.h"
 #include "../opt/de.h"
@@ -9,12 +12,13 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <future>
+#include <limits>
 #include <memory>
-#include <numeric>
 #include <print>
 #include <thread>
 #include <vector>
@@ -131,16 +135,76 @@ void FrameCoder::SetParam(
     param.nS1 = -param.nS1;
     param.ch_ref = 1;
   } // else if (param.nS1==0) param.nS1=1;
+
+  // solver variants are stored per channel, predictor channel 0 is ch_ref
+  for(std::int32_t i = 0; i < 2; i++) {
+    const std::int32_t ch = numchannels_ > 1 ? (param.ch_ref ^ i) : 0;
+    param.fast_ols[i] = framestats[ch].fast_ols;
+    param.lms_f32[i] = framestats[ch].lms_f32;
+  }
 }
 
+namespace {
+  // profile coefficients that set the predictor layout: ols orders and
+  // nS1 sign (ch_ref), lms stage lengths, lm_n
+  constexpr std::array<std::int32_t, 14> STRUCTURE_PARAMS = {
+    9, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 37, 38, 41
+  };
+
+  // position of the second channel at the time the serial stereo loop
+  // predicts sample idx0 of the reference channel
+  std::int32_t StereoRefIndex(
+    std::int32_t idx0, std::int32_t nS1, std::int32_t numsamples
+  ) {
+    return std::clamp(idx0 - std::max(nS1 - 1, 0), 0, numsamples);
+  }
+
+  // waits until the other channel published count samples
+  void WaitProgress(
+    const std::atomic<std::int32_t>& progress, std::int32_t count
+  ) {
+    std::int32_t spin = 0;
+    while(progress.load(std::memory_order_acquire) < count) {
+      if(spin < 64) {
+        spin++;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+} // namespace
+
 void FrameCoder::PredictFrame(
   const SacProfile& profile, tch_samples& error, std::int32_t from,
   std::int32_t numsamples, bool optimize
 ) {
   Predictor::tparam param;
   SetParam(param, profile, optimize);
-  Predictor pr(param);
+  PredictorOrders::Dispatch(param, [&](auto& pr) {
+    PredictFrame(pr, param, error, from, numsamples, optimize);
+  });
+}
 
+void FrameCoder::PredictFrame(
+  const SacProfile& profile, std::span<const std::uint8_t> state,
+  tch_samples& error, std::int32_t from, std::int32_t numsamples
+) {
+  Predictor::tparam param;
+  SetParam(param, profile, true);
+  PredictorOrders::Dispatch(param, [&](auto& pr) {
+    if(pr.LoadState(state)) {
+      PredictFrame(pr, param, error, 0, from + numsamples, true, from);
+    } else {
+      PredictFrame(pr, param, error, from, numsamples, true);
+    }
+  });
+}
+
+template<typename TPredictor>
+void FrameCoder::PredictFrame(
+  TPredictor& pr, const Predictor::tparam& param, tch_samples& error,
+  std::int32_t from, std::int32_t numsamples, bool optimize, std::int32_t skip
+) {
   auto eprocess = [&](
                     std::int32_t ch_p, std::int32_t ch, std::int32_t val,
                     std::int32_t idx
@@ -151,13 +215,39 @@ void FrameCoder::PredictFrame(
       framestats[ch].maxval
     );
     if(!optimize) { pred[ch][idx] = pi + framestats[ch].mean; }
-    error[ch][idx] = val - pi; // needed for cost-function within optimize
+    // needed for cost-function within optimize
+    error[ch][idx - skip] = val - pi;
     pr.update(ch_p, val);
   };
 
+  // pipelined stereo, the channel predictors share no state. the input is
+  // known, so ch0 reads ch1 at the position of the serial loop without waiting
+  if(numchannels_ == 2 && !optimize && cfg.mt_mode > 2) {
+    const std::int32_t ch0 = param.ch_ref;
+    const std::int32_t ch1 = 1 - ch0;
+    const auto& src0 = samples[ch0];
+    const auto& src1 = samples[ch1];
+
+    std::jthread worker([&] {
+      const AllocCheck::Scope alloc_check("PredictFrame ch1");
+      for(std::int32_t idx1 = 0; idx1 < numsamples; idx1++) {
+        pr.fillbuf_ch1(&src0[from], &src1[from], idx1, numsamples);
+        eprocess(1, ch1, src1[from + idx1], idx1);
+      }
+    });
+    const AllocCheck::Scope alloc_check("PredictFrame ch0");
+    for(std::int32_t idx0 = 0; idx0 < numsamples; idx0++) {
+      const std::int32_t idx1 = StereoRefIndex(idx0, param.nS1, numsamples);
+      pr.fillbuf_ch0(&src0[from], idx0, &src1[from], idx1);
+      eprocess(0, ch0, src0[from + idx0], idx0);
+    }
+    return;
+  }
+
+  const AllocCheck::Scope alloc_check("PredictFrame");
   if(numchannels_ == 1) {
     const auto& src = samples[0];
-    for(std::int32_t idx = 0; idx < numsamples; idx++) {
+    for(std::int32_t idx = skip; idx < numsamples; idx++) {
       pr.fillbuf_ch0(&src[from], idx, &src[from], idx);
       eprocess(0, 0, src[from + idx], idx);
     }
@@ -168,15 +258,15 @@ void FrameCoder::PredictFrame(
     const auto& src0 = samples[ch0];
     const auto& src1 = samples[ch1];
 
-    std::int32_t idx0 = 0;
-    std::int32_t idx1 = 0;
+    std::int32_t idx0 = skip;
+    std::int32_t idx1 = skip;
     while(idx0 < numsamples || idx1 < numsamples) {
       if(idx0 < numsamples) {
         pr.fillbuf_ch0(&src0[from], idx0, &src1[from], idx1);
         eprocess(0, ch0, src0[from + idx0], idx0);
         idx0++;
       }
-      if(idx0 >= param.nS1) {
+      if(idx0 >= skip + param.nS1) {
         pr.fillbuf_ch1(&src0[from], &src1[from], idx1, numsamples);
         eprocess(1, ch1, src1[from + idx1], idx1);
         idx1++;
@@ -190,8 +280,15 @@ void FrameCoder::UnpredictFrame(
 ) {
   Predictor::tparam param;
   SetParam(param, profile, false);
-  Predictor pr(param);
+  PredictorOrders::Dispatch(param, [&](auto& pr) {
+    UnpredictFrame(pr, param, numsamples);
+  });
+}
 
+template<typename TPredictor>
+void FrameCoder::UnpredictFrame(
+  TPredictor& pr, const Predictor::tparam& param, std::int32_t numsamples
+) {
   auto dprocess = [&](
                     std::int32_t ch_p, std::int32_t ch,
                     std::vector<std::int32_t>& dst, std::int32_t idx
@@ -213,13 +310,43 @@ void FrameCoder::UnpredictFrame(
     pr.update(ch_p, dst[idx]);
   };
 
-  if(numchannels_ == 1) {
+  // pipelined stereo, the reconstructed samples are published through
+  // per-channel progress counters. ch1 trails ch0 by nS1 samples,
+  // ch0 only waits for ch1 if it uses ch1 history (nM0 > 0)
+  if(numchannels_ == 2 && cfg.mt_mode > 2) {
+    const std::int32_t ch0 = param.ch_ref;
+    const std::int32_t ch1 = 1 - ch0;
+    auto& dst0 = samples[ch0];
+    auto& dst1 = samples[ch1];
+    std::atomic<std::int32_t> done0{0};
+    std::atomic<std::int32_t> done1{0};
+
+    std::jthread worker([&] {
+      const AllocCheck::Scope alloc_check("UnpredictFrame ch1");
+      for(std::int32_t idx1 = 0; idx1 < numsamples; idx1++) {
+        WaitProgress(done0, std::min(idx1 + param.nS1, numsamples));
+        pr.fillbuf_ch1(dst0.data(), dst1.data(), idx1, numsamples);
+        dprocess(1, ch1, dst1, idx1);
+        done1.store(idx1 + 1, std::memory_order_release);
+      }
+    });
+    const AllocCheck::Scope alloc_check("UnpredictFrame ch0");
+    for(std::int32_t idx0 = 0; idx0 < numsamples; idx0++) {
+      const std::int32_t idx1 = StereoRefIndex(idx0, param.nS1, numsamples);
+      if(param.nM0 > 0) { WaitProgress(done1, idx1); }
+      pr.fillbuf_ch0(dst0.data(), idx0, dst1.data(), idx1);
+      dprocess(0, ch0, dst0, idx0);
+      done0.store(idx0 + 1, std::memory_order_release);
+    }
+  } else if(numchannels_ == 1) {
+    const AllocCheck::Scope alloc_check("UnpredictFrame");
     auto& dst = samples[0];
     for(std::int32_t idx = 0; idx < numsamples; idx++) {
       pr.fillbuf_ch0(dst.data(), idx, dst.data(), idx);
       dprocess(0, 0, dst, idx);
     }
   } else if(numchannels_ == 2) {
+    const AllocCheck::Scope alloc_check("UnpredictFrame");
     std::int32_t ch0 = param.ch_ref;
     std::int32_t ch1 = 1 - ch0;
 
@@ -258,9 +385,9 @@ std::size_t FrameCoder::EncodeMonoFrame_Normal(
   RangeCoderSH rc(buf);
   rc.Init();
 
-  BitplaneCoder bc(framestats[ch].maxbpn, numsamples);
+  auto bc = BitplaneCoderPool::Get(framestats[ch].maxbpn, numsamples);
   std::int32_t* psrc = s2u_error[ch].data();
-  bc.Encode(rc.encode_p1, psrc);
+  bc->Encode(rc, psrc);
   rc.Stop();
   return buf.GetBufPos();
 }
@@ -273,11 +400,11 @@ std::size_t FrameCoder::EncodeMonoFrame_Mapped(
   RangeCoderSH rc(buf);
   rc.Init();
 
-  BitplaneCoder bc(framestats[ch].maxbpn_map, numsamples);
+  auto bc = BitplaneCoderPool::Get(framestats[ch].maxbpn_map, numsamples);
 
-  MapEncoder me(rc, framestats[ch].mymap.usedl, framestats[ch].mymap.usedh);
-  me.Encode();
-  bc.Encode(rc.encode_p1, s2u_error_map[ch].data());
+  MapEncoder me(framestats[ch].mymap.usedl, framestats[ch].mymap.usedh);
+  me.Encode(rc);
+  bc->Encode(rc, s2u_error_map[ch].data());
   rc.Stop();
   return buf.GetBufPos();
 }
@@ -355,13 +482,13 @@ void FrameCoder::DecodeMonoFrame(std::int32_t ch, std::int32_t numsamples) {
   rc.Init();
   if(framestats[ch].enc_mapped) {
     framestats[ch].mymap.Reset();
-    MapEncoder me(rc, framestats[ch].mymap.usedl, framestats[ch].mymap.usedh);
-    me.Decode();
+    MapEncoder me(framestats[ch].mymap.usedl, framestats[ch].mymap.usedh);
+    me.Decode(rc);
     // std::cout << buf.GetBufPos() << std::endl;
   }
 
-  BitplaneCoder bc(framestats[ch].maxbpn, numsamples);
-  bc.Decode(rc.decode_p1, dst);
+  auto bc = BitplaneCoderPool::Get(framestats[ch].maxbpn, numsamples);
+  bc->Decode(rc, dst);
   rc.Stop();
 }
 
@@ -481,6 +608,19 @@ void FrameCoder::Optimize(
     xstart[i] = profile.coefs[params_to_optimize[i]].vdef;
   }
 
+  // the predictor state after the samples before the optimized segment,
+  // each evaluation resumes from it instead of starting cold
+  std::vector<std::uint8_t> warm_state;
+  if(ocfg.warm_start != 0 && start_pos > 0) {
+    tch_samples tmp_error(numchannels_, std::vector<std::int32_t>(start_pos));
+    Predictor::tparam param;
+    SetParam(param, profile, true);
+    PredictorOrders::Dispatch(param, [&](auto& pr) {
+      PredictFrame(pr, param, tmp_error, 0, start_pos, true);
+      pr.SaveState(warm_state);
+    });
+  }
+
   auto cost_func = [&](const vec1D& x) {
     // create thread safe copies for error and profile
     tch_samples tmp_error(
@@ -492,7 +632,15 @@ void FrameCoder::Optimize(
       tmp_profile.coefs[params_to_optimize[i]].vdef = static_cast<float>(x[i]);
     }
 
-    PredictFrame(tmp_profile, tmp_error, start_pos, samples_to_optimize, true);
+    if(warm_state.empty()) {
+      PredictFrame(
+        tmp_profile, tmp_error, start_pos, samples_to_optimize, true
+      );
+    } else {
+      PredictFrame(
+        tmp_profile, warm_state, tmp_error, start_pos, samples_to_optimize
+      );
+    }
     return GetCost(CostFunc, tmp_error, samples_to_optimize);
   };
 
@@ -546,6 +694,14 @@ void FrameCoder::CnvError_S2U(
 
 void FrameCoder::Predict() {
   for(std::int32_t ch = 0; ch < numchannels_; ch++) {
+    framestats[ch].fast_ols = cfg.fast_ols != 0;
+    framestats[ch].lms_f32 = cfg.lms_f32 != 0;
+    framestats[ch].has_crc = cfg.frame_crc != 0;
+    if(framestats[ch].has_crc) {
+      framestats[ch].crc = CRC32C::Samples(
+        std::span<const std::int32_t>(samples[ch].data(), numsamples_)
+      );
+    }
     AnalyseMonoChannel(ch, numsamples_);
     if(cfg.sparse_pcm != 0) {
       framestats[ch].mymap.Reset();
@@ -568,9 +724,17 @@ void FrameCoder::Predict() {
     // last frame
     if(cfg.ocfg.reset != 0) { base_profile.LoadBaseProfile(); }
 
-    // optimize all params
-    std::vector<std::int32_t> lparam_base(base_profile.coefs.size());
-    std::iota(std::begin(lparam_base), std::end(lparam_base), 0);
+    // optimize all params. a warm start only resumes predictors of the
+    // same layout, so the structure stays fixed: otherwise warm and cold
+    // evaluations would compete in one search
+    std::vector<std::int32_t> lparam_base;
+    const auto nparams = static_cast<std::int32_t>(base_profile.get_size());
+    for(std::int32_t i = 0; i < nparams; i++) {
+      if(cfg.ocfg.warm_start == 0
+         || std::ranges::find(STRUCTURE_PARAMS, i) == STRUCTURE_PARAMS.end()) {
+        lparam_base.push_back(i);
+      }
+    }
 
     Optimize(cfg.ocfg, base_profile, lparam_base);
   }
@@ -580,6 +744,15 @@ void FrameCoder::Predict() {
 
 void FrameCoder::Unpredict() { UnpredictFrame(base_profile, numsamples_); }
 
+// compare the decoded samples against the stored crc
+bool FrameCoder::VerifyCRC(std::int32_t ch) const {
+  if(!framestats[ch].has_crc) { return true; }
+  return CRC32C::Samples(
+           std::span<const std::int32_t>(samples[ch].data(), numsamples_)
+         )
+         == framestats[ch].crc;
+}
+
 void FrameCoder::Encode() {
   if((cfg.mt_mode != 0) && numchannels_ > 1) {
     std::vector<std::jthread> threads;
@@ -639,10 +812,9 @@ void FrameCoder::DecodeProfile(
 }
 
 std::int32_t FrameCoder::WriteBlockHeader(
-  std::fstream& file, const std::vector<SacProfile::FrameStats>& framestats,
-  std::int32_t ch
+  std::span<std::uint8_t> buf,
+  const std::vector<SacProfile::FrameStats>& framestats, std::int32_t ch
 ) {
-  std::array<std::uint8_t, 32> buf{};
   BitUtils::put32LH(
     std::span<std::uint8_t, 4>(buf.data(), 4), framestats[ch].blocksize
   );
@@ -665,9 +837,18 @@ std::int32_t FrameCoder::WriteBlockHeader(
   } else {
     flag |= static_cast<uint32_t>(framestats[ch].maxbpn);
   }
+  if(framestats[ch].fast_ols) { flag |= (1U << 11U); }
+  if(framestats[ch].lms_f32) { flag |= (1U << 12U); }
+  if(framestats[ch].has_crc) {
+    flag |= (1U << 10U);
+    BitUtils::put32LH(
+      std::span<std::uint8_t, 4>(&buf[BLOCK_HEADER_SIZE], 4),
+      framestats[ch].crc
+    );
+  }
   BitUtils::put16LH(std::span<std::uint8_t, 2>(&buf[16], 2), flag);
-  file.write(reinterpret_cast<char*>(buf.data()), 18);
-  return 18;
+  return framestats[ch].has_crc ? BLOCK_HEADER_SIZE + BLOCK_CRC_SIZE
+                                : BLOCK_HEADER_SIZE;
 }
 
 std::int32_t FrameCoder::ReadBlockHeader(
@@ -675,7 +856,7 @@ std::int32_t FrameCoder::ReadBlockHeader(
   std::int32_t ch
 ) {
   std::array<std::uint8_t, 32> buf{};
-  file.read(reinterpret_cast<char*>(buf.data()), 18);
+  file.read(reinterpret_cast<char*>(buf.data()), BLOCK_HEADER_SIZE);
 
   framestats[ch].blocksize = static_cast<std::int32_t>(
     BitUtils::get32LH(std::span<std::uint8_t, 4>(buf.data(), 4))
@@ -691,24 +872,46 @@ std::int32_t FrameCoder::ReadBlockHeader(
   );
   std::uint16_t flag =
     BitUtils::get16LH(std::span<std::uint8_t, 2>(&buf[16], 2));
-  framestats[ch].enc_mapped = (flag >> 9U) != 0;
+  if((flag & BLOCK_FLAGS_UNKNOWN) != 0) { return -1; }
+  framestats[ch].enc_mapped = ((flag >> 9U) & 1U) != 0;
   framestats[ch].maxbpn = static_cast<std::int32_t>(flag & 0xffU);
-  return 18;
+  framestats[ch].has_crc = ((flag >> 10U) & 1U) != 0;
+  framestats[ch].fast_ols = ((flag >> 11U) & 1U) != 0;
+  framestats[ch].lms_f32 = ((flag >> 12U) & 1U) != 0;
+  if(framestats[ch].has_crc) {
+    file.read(reinterpret_cast<char*>(buf.data()), BLOCK_CRC_SIZE);
+    framestats[ch].crc =
+      BitUtils::get32LH(std::span<std::uint8_t, 4>(buf.data(), 4));
+    return BLOCK_HEADER_SIZE + BLOCK_CRC_SIZE;
+  }
+  return BLOCK_HEADER_SIZE;
 }
 
-void FrameCoder::WriteEncoded(AudioFile<AudioFileBase::Mode::Write>& fout) {
-  std::array<std::uint8_t, 12> buf{};
-  BitUtils::put32LH(std::span<std::uint8_t, 4>(buf.data(), 4), numsamples_);
-  fout.file.write(reinterpret_cast<char*>(buf.data()), 4);
+// append the serialized frame to buf, written to disk in one go
+void FrameCoder::WriteEncoded(std::vector<std::uint8_t>& buf) {
+  std::size_t framesize = 4 + profile_size_bytes_;
+  for(std::int32_t ch = 0; ch < numchannels_; ch++) {
+    framestats[ch].blocksize = static_cast<int32_t>(encoded[ch].GetBufPos());
+    framesize += BLOCK_HEADER_SIZE + framestats[ch].blocksize;
+    if(framestats[ch].has_crc) { framesize += BLOCK_CRC_SIZE; }
+  }
+  std::size_t ofs = buf.size();
+  buf.resize(ofs + framesize);
+
+  BitUtils::put32LH(std::span<std::uint8_t, 4>(&buf[ofs], 4), numsamples_);
+  ofs += 4;
   std::vector<std::uint8_t> profile_buf(profile_size_bytes_);
   EncodeProfile(base_profile, profile_buf);
-  fout.file.write(
-    reinterpret_cast<char*>(profile_buf.data()), profile_size_bytes_
-  );
+  std::copy_n(profile_buf.begin(), profile_size_bytes_, &buf[ofs]);
+  ofs += profile_size_bytes_;
   for(std::int32_t ch = 0; ch < numchannels_; ch++) {
-    framestats[ch].blocksize = static_cast<int32_t>(encoded[ch].GetBufPos());
-    WriteBlockHeader(fout.file, framestats, ch);
-    fout.Write(encoded[ch].GetBuf(), framestats[ch].blocksize);
+    ofs += WriteBlockHeader(
+      std::span<std::uint8_t>(&buf[ofs], buf.size() - ofs), framestats, ch
+    );
+    std::copy_n(
+      encoded[ch].GetBuf().begin(), framestats[ch].blocksize, &buf[ofs]
+    );
+    ofs += framestats[ch].blocksize;
   }
 }
 
@@ -718,6 +921,7 @@ void FrameCoder::ReadEncoded(AudioFile<AudioFileBase::Mode::Read>& fin) {
   numsamples_ = static_cast<int32_t>(
     BitUtils::get32LH(std::span<std::uint8_t, 4>(buf.data(), 4))
   );
+  if(numsamples_ == 0) { return; } // end of stream marker
   std::vector<std::uint8_t> profile_buf(profile_size_bytes_);
   fin.file.read(
     reinterpret_cast<char*>(profile_buf.data()), profile_size_bytes_
@@ -725,7 +929,11 @@ void FrameCoder::ReadEncoded(AudioFile<AudioFileBase::Mode::Read>& fin) {
   DecodeProfile(base_profile, profile_buf);
 
   for(std::int32_t ch = 0; ch < numchannels_; ch++) {
-    ReadBlockHeader(fin.file, framestats, ch);
+    if(ReadBlockHeader(fin.file, framestats, ch) < 0) {
+      std::cerr << "\n  error: unsupported block flags\n";
+      numsamples_ = 0; // stop like at the end of stream
+      return;
+    }
     fin.Read(encoded[ch].GetBuf(), framestats[ch].blocksize);
   }
 }
@@ -797,6 +1005,10 @@ void FrameCoder::AnalyseMonoChannel(std::int32_t ch, std::int32_t numsamples) {
 void Codec::PrintProgress(
   std::int32_t samplesprocessed, std::int32_t totalsamples
 ) {
+  if(totalsamples <= 0) { // unknown length
+    std::cout << "  " << samplesprocessed << "\r";
+    return;
+  }
   double r = samplesprocessed * 100.0 / static_cast<double>(totalsamples);
   std::cout << "  " << samplesprocessed << "/" << totalsamples << ":"
             << std::setw(6) << miscUtils::ConvertFixed(r, 1) << "%\r";
@@ -814,12 +1026,14 @@ void Codec::ScanFrames(Sac<AudioFileBase::Mode::Read>& mySac) {
   std::int32_t frame_num = 1;
   std::int32_t coef_hdr_size = 0;
   std::int32_t block_hdr_size = 0;
-  while(mySac.file.tellg() < fsize) {
+  // prints one frame, returns its number of samples
+  const auto scan_frame = [&]() {
     std::array<std::uint8_t, 12> buf{};
     mySac.file.read(reinterpret_cast<char*>(buf.data()), 4);
     std::int32_t numsamples = static_cast<std::int32_t>(
       BitUtils::get32LH(std::span<std::uint8_t, 4>(buf.data(), 4))
     );
+    if(numsamples == 0) { return 0; } // end of stream marker
     std::cout << "Frame " << frame_num << ": " << numsamples << " samples "
               << '\n';
 
@@ -831,17 +1045,49 @@ void Codec::ScanFrames(Sac<AudioFileBase::Mode::Read>& mySac) {
     for(std::int32_t ch = 0; ch < mySac.getNumChannels(); ch++) {
       std::int32_t num_bytes =
         FrameCoder::ReadBlockHeader(mySac.file, framestats, ch);
+      if(num_bytes < 0) {
+        std::cout << "  Channel " << ch << ": unsupported block flags\n";
+        return 0;
+      }
       block_hdr_size += num_bytes;
       std::cout << "  Channel " << ch << ": " << framestats[ch].blocksize
                 << " bytes\n";
       std::cout << "    Bpn: " << framestats[ch].maxbpn
-                << ", sparse_pcm: " << (framestats[ch].enc_mapped) << '\n';
+                << ", sparse_pcm: " << (framestats[ch].enc_mapped)
+                << ", fast_ols: " << (framestats[ch].fast_ols)
+                << ", lms_f32: " << (framestats[ch].lms_f32) << '\n';
       std::cout << "    mean: " << framestats[ch].mean
                 << ", min: " << framestats[ch].minval
                 << ", max: " << framestats[ch].maxval << '\n';
+      if(framestats[ch].has_crc) {
+        std::cout << "    crc32c: " << std::format("{:08x}", framestats[ch].crc)
+                  << '\n';
+      }
       mySac.file.seekg(framestats[ch].blocksize, std::ios_base::cur);
     }
     frame_num++;
+    return numsamples;
+  };
+
+  if(mySac.ReadSeekTable()) { // jump to frames via the index
+    for(const auto& entry: mySac.seektable) {
+      mySac.file.seekg(static_cast<std::streamoff>(entry.pos));
+      std::cout << "@" << entry.pos << " sample " << entry.first_sample
+                << ' ';
+      scan_frame();
+    }
+  } else {
+    // the header sample count bounds the walk, a seek table with a broken
+    // trailer follows the last frame and must not be parsed as one
+    std::int64_t samplestoscan =
+      (mySac.mcfg.flags & SacBase::FLAG_STREAM) != 0
+        ? std::numeric_limits<std::int64_t>::max()
+        : mySac.getNumSamples();
+    while(samplestoscan > 0 && mySac.file && mySac.file.tellg() < fsize) {
+      const std::int32_t n = scan_frame();
+      if(n == 0) { break; }
+      samplestoscan -= n;
+    }
   }
   std::cout << "Frames   " << (frame_num - 1) << '\n';
   std::cout << "Hdr_size " << (coef_hdr_size + block_hdr_size) << " (coefs "
@@ -955,6 +1201,35 @@ std::vector<Codec::tsub_frame> Codec::Analyse(
   return sub_frames;
 }
 
+// one FrameCoder per frame in flight
+Codec::tframes
+Codec::CreateFrames(std::int32_t numchannels, std::int32_t framesize) const {
+  const auto frame_threads =
+    static_cast<std::size_t>(std::max(opt_.frame_threads, 1));
+  tframes frames;
+  frames.reserve(frame_threads);
+  for(std::size_t i = 0; i < frame_threads; i++) {
+    frames.emplace_back(
+      std::make_unique<FrameCoder>(numchannels, framesize, opt_)
+    );
+  }
+  return frames;
+}
+
+// run func(frame) on the first nframes frames, one thread per frame
+template<typename F>
+void Codec::RunFrames(tframes& frames, std::size_t nframes, F func) {
+  if(nframes > 1) {
+    std::vector<std::jthread> threads;
+    threads.reserve(nframes);
+    for(std::size_t i = 0; i < nframes; i++) {
+      threads.emplace_back([&func, &frame = *frames[i]] { func(frame); });
+    }
+  } else if(nframes == 1) {
+    func(*frames[0]);
+  }
+}
+
 std::int32_t Codec::EncodeFile(
   Wav<AudioFileBase::Mode::Read>& myWav, Sac<AudioFileBase::Mode::Write>& mySac
 ) {
@@ -962,12 +1237,20 @@ std::int32_t Codec::EncodeFile(
 
   const std::int32_t numchannels = myWav.getNumChannels();
 
-  FrameCoder myFrame(numchannels, max_framesize, opt_);
+  tframes frames = CreateFrames(numchannels, max_framesize);
 
   mySac.mcfg.max_framelen = opt_.max_framelen;
+  // a pipe can't be patched afterwards: numsamples and md5 follow the frames
+  const bool stream_out = mySac.isStream();
+  if(stream_out) {
+    mySac.mcfg.flags |= SacBase::FLAG_STREAM;
+  } else if(opt_.seek_table != 0) {
+    mySac.mcfg.flags |= SacBase::FLAG_SEEKTABLE;
+  }
+  const bool seek_table = (mySac.mcfg.flags & SacBase::FLAG_SEEKTABLE) != 0;
 
   mySac.WriteHeader(myWav);
-  std::streampos hdrpos = mySac.file.tellg();
+  std::streampos hdrpos = stream_out ? std::streampos(0) : mySac.file.tellp();
   mySac.WriteMD5(myWav.md5ctx.digest.data());
   myWav.InitFileBuf(max_framesize);
 
@@ -978,19 +1261,84 @@ std::int32_t Codec::EncodeFile(
 
   gtimer.start();
   std::int32_t samplescoded = 0;
-  std::int32_t samplestocode = myWav.getNumSamples();
-  std::vector<std::vector<std::int32_t>> csamples(
-    myWav.getNumChannels(), std::vector<std::int32_t>(max_framesize)
+  // two input blocks: the next one is read while the current one is coded
+  std::array<std::vector<std::vector<std::int32_t>>, 2> csamples;
+  csamples.fill(
+    std::vector<std::vector<std::int32_t>>(
+      myWav.getNumChannels(), std::vector<std::int32_t>(max_framesize)
+    )
   );
 
-  while(samplestocode > 0) {
-    std::int32_t samplesread = myWav.ReadSamples(csamples, max_framesize);
+  // encoded frames are serialized into outbuf and written in the
+  // background while the next batch is predicted
+  std::vector<std::uint8_t> outbuf;
+  std::future<void> pending_write;
+  std::uint64_t framepos =
+    stream_out ? 0 : static_cast<std::uint64_t>(mySac.file.tellp());
+
+  // predict and encode a batch of frames, then write them in order
+  // warm-start policy with --optimize: every frame of a batch starts
+  // from the profile of the last frame of the previous batch, which keeps
+  // the output independent of thread timing
+  std::size_t nframes = 0;
+  const auto flush_frames = [&]() {
+    for(std::size_t i = 1; i < nframes; i++) {
+      frames[i]->SetProfile(frames[0]->GetProfile());
+    }
+
+    ltimer.start();
+    RunFrames(frames, nframes, [](FrameCoder& frame) { frame.Predict(); });
+    ltimer.stop();
+    time_prd += ltimer.elapsedS();
+    ltimer.start();
+    RunFrames(frames, nframes, [](FrameCoder& frame) { frame.Encode(); });
+    ltimer.stop();
+    time_enc += ltimer.elapsedS();
+
+    if(pending_write.valid()) { pending_write.get(); }
+    outbuf.clear();
+    for(std::size_t i = 0; i < nframes; i++) {
+      if(seek_table) {
+        mySac.AddSeekEntry(
+          framepos + outbuf.size(), static_cast<std::uint32_t>(samplescoded),
+          static_cast<std::uint32_t>(frames[i]->GetNumSamples())
+        );
+      }
+      frames[i]->WriteEncoded(outbuf);
+
+      samplescoded += frames[i]->GetNumSamples();
+      PrintProgress(samplescoded, myWav.getNumSamples());
+    }
+    framepos += outbuf.size();
+    pending_write = std::async(std::launch::async, [&mySac, &outbuf] {
+      mySac.Write(outbuf, outbuf.size());
+    });
+    if(nframes > 1) {
+      frames[0]->SetProfile(frames[nframes - 1]->GetProfile());
+    }
+    nframes = 0;
+  };
+
+  // read until the input is exhausted, the length of a piped wav
+  // may be unknown
+  const auto read_block = [&myWav, max_framesize](auto& block) {
+    return std::async(std::launch::async, [&myWav, &block, max_framesize] {
+      return myWav.ReadSamples(block, max_framesize);
+    });
+  };
+  std::size_t curblock = 0;
+  std::future<std::int32_t> next_read = read_block(csamples[curblock]);
+  std::int32_t samplesread = 0;
+  while((samplesread = next_read.get()) > 0) {
+    const auto& block = csamples[curblock];
+    curblock ^= 1U;
+    next_read = read_block(csamples[curblock]);
 
     std::vector<Codec::tsub_frame> sub_frames;
     if(opt_.adapt_block != 0) {
       std::int32_t block_len = myWav.getSampleRate() * 3;
       std::int32_t min_frame_len = myWav.getSampleRate() * 3;
-      sub_frames = Analyse(csamples, block_len, min_frame_len, samplesread);
+      sub_frames = Analyse(block, block_len, min_frame_len, samplesread);
     } else {
       sub_frames.push_back({0, 0, samplesread});
     }
@@ -1001,31 +1349,24 @@ std::int32_t Codec::EncodeFile(
                   << " len " << subframe.length << '\n';
       }
 
+      FrameCoder& myFrame = *frames[nframes];
       for(std::int32_t ch = 0; ch < myWav.getNumChannels(); ch++) {
         std::copy_n(
-          &csamples[ch][subframe.start], subframe.length,
+          &block[ch][subframe.start], subframe.length,
           myFrame.samples[ch].data()
         );
       }
 
       myFrame.SetNumSamples(subframe.length);
 
-      ltimer.start();
-      myFrame.Predict();
-      ltimer.stop();
-      time_prd += ltimer.elapsedS();
-      ltimer.start();
-      myFrame.Encode();
-      ltimer.stop();
-      time_enc += ltimer.elapsedS();
-      myFrame.WriteEncoded(mySac);
-
-      samplescoded += subframe.length;
-      PrintProgress(samplescoded, myWav.getNumSamples());
-      samplestocode -= subframe.length;
+      if(++nframes == frames.size()) { flush_frames(); }
     }
   }
-  MD5::Finalize(&myWav.md5ctx);
+  flush_frames();
+  if(pending_write.valid()) { pending_write.get(); }
+  if(seek_table) { mySac.WriteSeekTable(); }
+
+  myWav.FinalizeMD5();
   gtimer.stop();
   double time_total = gtimer.elapsedS();
   if(time_total > 0.) {
@@ -1043,43 +1384,295 @@ std::int32_t Codec::EncodeFile(
   }
   std::cout << std::dec << '\n';
 
-  std::streampos eofpos = mySac.file.tellg();
-  mySac.file.seekg(hdrpos);
-  mySac.WriteMD5(myWav.md5ctx.digest.data());
-  mySac.file.seekg(eofpos);
+  if(stream_out) {
+    mySac.WriteEndRecord(
+      static_cast<std::uint32_t>(samplescoded), myWav.md5ctx.digest.data()
+    );
+  } else {
+    std::streampos eofpos = mySac.file.tellp();
+    mySac.file.seekp(hdrpos);
+    mySac.WriteMD5(myWav.md5ctx.digest.data());
+    mySac.file.seekp(eofpos);
+    mySac.WriteNumSamples(static_cast<std::uint32_t>(samplescoded));
+    if(myWav.isStream()) { // store the real sizes of a piped wav
+      myWav.SetNumSamples(samplescoded);
+      mySac.file.seekp(0);
+      mySac.WriteHeader(myWav);
+      mySac.file.seekp(eofpos);
+    }
+  }
   return 0;
 }
 
+// read the frame containing sample into frame, returns its first sample.
+// uses the seek table if present, otherwise reads forward frame by frame,
+// which works on pipes too. frame is empty if the file ends before sample
+std::int32_t Codec::SeekFrame(
+  Sac<AudioFileBase::Mode::Read>& mySac, FrameCoder& frame, std::int32_t sample
+) {
+  if(mySac.ReadSeekTable() && !mySac.seektable.empty()) {
+    const auto& table = mySac.seektable;
+    auto it = std::ranges::upper_bound(
+      table, static_cast<std::uint32_t>(sample), {},
+      &SacBase::tframe_entry::first_sample
+    );
+    if(it != table.begin()) { --it; }
+    mySac.file.seekg(static_cast<std::streamoff>(it->pos));
+    frame.ReadEncoded(mySac);
+    return static_cast<std::int32_t>(it->first_sample);
+  }
+
+  std::int32_t framestart = 0;
+  while(true) {
+    frame.ReadEncoded(mySac);
+    if(frame.GetNumSamples() == 0
+       || framestart + frame.GetNumSamples() > sample) {
+      break;
+    }
+    framestart += frame.GetNumSamples();
+  }
+  return framestart;
+}
+
 void Codec::DecodeFile(
   Sac<AudioFileBase::Mode::Read>& mySac, Wav<AudioFileBase::Mode::Write>& myWav
 ) {
   const SacBase::sac_cfg& file_cfg = mySac.mcfg;
   myWav.InitFileBuf(static_cast<std::int32_t>(file_cfg.max_framesize));
   mySac.UnpackMetaData(myWav);
+
+  // sample range [range_start,range_end) to decode, whole file by default.
+  // the length of a streamed file is only known at the end marker, the
+  // wav header is rewritten with the decoded length then
+  const bool stream_in = (file_cfg.flags & SacBase::FLAG_STREAM) != 0;
+  const std::int32_t numsamples = mySac.getNumSamples();
+  std::int32_t range_start = std::max(opt_.decode_start, 0);
+  std::int32_t range_end = std::numeric_limits<std::int32_t>::max();
+  if(opt_.decode_end >= 0) { range_end = std::max(opt_.decode_end, 0); }
+  if(!stream_in) {
+    range_start = std::min(range_start, numsamples);
+    range_end = std::clamp(range_end, range_start, numsamples);
+    if(range_start != 0 || range_end != numsamples) {
+      myWav.SetNumSamples(range_end - range_start);
+    }
+  }
   myWav.WriteHeader();
 
   opt_.max_framelen = file_cfg.max_framelen;
-  FrameCoder myFrame(
-    mySac.getNumChannels(), static_cast<std::int32_t>(file_cfg.max_framesize),
-    opt_
+  tframes frames = CreateFrames(
+    mySac.getNumChannels(), static_cast<std::int32_t>(file_cfg.max_framesize)
   );
 
+  // frames[0] holds the first frame of the range after seeking
+  std::int32_t framestart = 0;
+  std::size_t nseeked = 0;
+  bool eos = false;
+  if(range_start > 0 && range_end > range_start) {
+    framestart = SeekFrame(mySac, *frames[0], range_start);
+    nseeked = 1;
+    eos = frames[0]->GetNumSamples() == 0;
+  }
+
+  // frames are independent: read a batch in file order,
+  // decode it in parallel and write the pcm in order.
+  // the next batch is read into a second set of frames meanwhile,
+  // and the pcm of the previous batch is written in the background
+  struct tbatch {
+    std::size_t nframes = 0;
+    std::int32_t samplesread = 0;
+    bool eos = false;
+  };
+  const auto read_batch = [&mySac](
+                            tframes& batch, std::int32_t maxsamples,
+                            std::size_t nloaded
+                          ) {
+    tbatch b;
+    for(; b.nframes < nloaded; b.nframes++) {
+      b.samplesread += batch[b.nframes]->GetNumSamples();
+    }
+    while(b.nframes < batch.size() && b.samplesread < maxsamples) {
+      batch[b.nframes]->ReadEncoded(mySac);
+      if(batch[b.nframes]->GetNumSamples() == 0) { // end of stream marker
+        b.eos = true;
+        break;
+      }
+      b.samplesread += batch[b.nframes]->GetNumSamples();
+      b.nframes++;
+    }
+    return b;
+  };
+  tframes frames_next = CreateFrames(
+    mySac.getNumChannels(), static_cast<std::int32_t>(file_cfg.max_framesize)
+  );
+
+  std::int32_t framenum = 0;
   std::int64_t data_nbytes = 0;
-  std::int32_t samplestodecode = mySac.getNumSamples();
+  std::int32_t samplestodecode =
+    range_end > range_start ? range_end - framestart : 0;
   std::int32_t samplesdecoded = 0;
-  while(samplestodecode > 0) {
-    myFrame.ReadEncoded(mySac);
-    myFrame.Decode();
-    myFrame.Unpredict();
-    data_nbytes += myWav.WriteSamples(myFrame.samples, myFrame.GetNumSamples());
+  // samples [first,first+count) of a decoded frame. the reads only touch
+  // the encoded blocks, so the samples stay valid until the set is decoded
+  // again two batches later
+  struct twrite {
+    const FrameCoder::tch_samples* samples;
+    std::int32_t first, count;
+  };
+  std::vector<twrite> writes;
+  std::future<void> pending_write;
+  tbatch batch;
+  if(samplestodecode > 0 && !eos) {
+    batch = read_batch(frames, samplestodecode, nseeked);
+  }
+  while(batch.nframes > 0) {
+    const std::size_t nframes = batch.nframes;
+    samplestodecode -= batch.samplesread;
+    std::future<tbatch> next_batch;
+    if(!batch.eos && samplestodecode > 0) {
+      next_batch = std::async(
+        std::launch::async, read_batch, std::ref(frames_next),
+        samplestodecode, std::size_t{0}
+      );
+    }
 
-    samplesdecoded += myFrame.GetNumSamples();
-    PrintProgress(samplesdecoded, myWav.getNumSamples());
-    samplestodecode -= myFrame.GetNumSamples();
+    RunFrames(frames, nframes, [](FrameCoder& frame) {
+      frame.Decode();
+      frame.Unpredict();
+    });
+
+    if(pending_write.valid()) { pending_write.get(); }
+    writes.clear();
+    for(std::size_t i = 0; i < nframes; i++) {
+      const FrameCoder& myFrame = *frames[i];
+      framenum++;
+      for(std::int32_t ch = 0; ch < mySac.getNumChannels(); ch++) {
+        if(!myFrame.VerifyCRC(ch)) {
+          std::cerr << "\nwarning: crc mismatch in frame " << framenum
+                    << ", channel " << ch << '\n';
+        }
+      }
+      // clip the frame to the requested range
+      const std::int32_t first = std::max(range_start - framestart, 0);
+      const std::int32_t last =
+        std::min(range_end - framestart, myFrame.GetNumSamples());
+      if(last > first) {
+        writes.push_back({&myFrame.samples, first, last - first});
+        samplesdecoded += last - first;
+      }
+      framestart += myFrame.GetNumSamples();
+      PrintProgress(samplesdecoded, myWav.getNumSamples());
+    }
+    pending_write =
+      std::async(std::launch::async, [&myWav, &writes, &data_nbytes] {
+        for(const auto& w: writes) {
+          data_nbytes += myWav.WriteSamples(*w.samples, w.count, w.first);
+        }
+      });
+    if(!next_batch.valid()) { break; }
+    batch = next_batch.get();
+    std::swap(frames, frames_next);
+  }
+  if(pending_write.valid()) { pending_write.get(); }
+  // the end record of a streamed file follows the end marker
+  eos = eos || batch.eos;
+  while(stream_in && !eos && mySac.file) {
+    frames[0]->ReadEncoded(mySac);
+    eos = frames[0]->GetNumSamples() == 0;
   }
   // pad odd sized data chunk
   if((static_cast<std::uint64_t>(data_nbytes) & 1U) != 0) {
     myWav.Write(std::vector<std::uint8_t>{0}, 1);
   }
   myWav.WriteHeader();
+  // the stored sizes of a streamed file may be placeholders
+  if(stream_in && !myWav.isStream()) {
+    myWav.SetNumSamples(samplesdecoded);
+    myWav.RewriteHeader();
+  }
+}
+
+// decode every frame without writing pcm, checks the per-frame crcs
+// and hashes the packed pcm into md5ctx. returns the number of bad frames
+std::int32_t Codec::TestFile(
+  Sac<AudioFileBase::Mode::Read>& mySac, MD5::MD5Context& md5ctx
+) {
+  const SacBase::sac_cfg& file_cfg = mySac.mcfg;
+  const std::int32_t numchannels = mySac.getNumChannels();
+  const std::int32_t csize = (mySac.getBitsPerSample() + 7) / 8;
+  opt_.max_framelen = file_cfg.max_framelen;
+  tframes frames = CreateFrames(
+    numchannels, static_cast<std::int32_t>(file_cfg.max_framesize)
+  );
+  tframes frames_next = CreateFrames(
+    numchannels, static_cast<std::int32_t>(file_cfg.max_framesize)
+  );
+
+  // frames end at numsamples or at the end marker of a streamed file
+  std::int32_t samplestoread = (file_cfg.flags & SacBase::FLAG_STREAM) != 0
+                                 ? std::numeric_limits<std::int32_t>::max()
+                                 : mySac.getNumSamples();
+  const auto read_batch = [&mySac, &samplestoread](tframes& batch) {
+    std::size_t nframes = 0;
+    while(nframes < batch.size() && samplestoread > 0) {
+      batch[nframes]->ReadEncoded(mySac);
+      const std::int32_t n = batch[nframes]->GetNumSamples();
+      if(n == 0) {
+        samplestoread = 0;
+        break;
+      }
+      samplestoread -= n;
+      nframes++;
+    }
+    return nframes;
+  };
+
+  std::vector<std::uint8_t> pcmbuf(
+    static_cast<std::size_t>(file_cfg.max_framesize) * numchannels * csize
+  );
+  std::int32_t framenum = 0;
+  std::int32_t badframes = 0;
+  std::int32_t samplestested = 0;
+  std::size_t nframes = read_batch(frames);
+  while(nframes > 0) {
+    std::future<std::size_t> next_batch;
+    if(samplestoread > 0) {
+      next_batch =
+        std::async(std::launch::async, read_batch, std::ref(frames_next));
+    }
+
+    RunFrames(frames, nframes, [](FrameCoder& frame) {
+      frame.Decode();
+      frame.Unpredict();
+    });
+
+    for(std::size_t i = 0; i < nframes; i++) {
+      const FrameCoder& myFrame = *frames[i];
+      framenum++;
+      bool frame_ok = true;
+      for(std::int32_t ch = 0; ch < numchannels; ch++) {
+        if(!myFrame.VerifyCRC(ch)) {
+          std::cout << "\n  Frame " << framenum << ", channel " << ch
+                    << ": crc mismatch\n";
+          frame_ok = false;
+        }
+      }
+      if(!frame_ok) { badframes++; }
+
+      const std::int32_t n = myFrame.GetNumSamples();
+      const std::size_t nbytes = static_cast<std::size_t>(n) * numchannels
+                                 * static_cast<std::size_t>(csize);
+      PCM::Pack(
+        myFrame.samples, 0, std::span<std::uint8_t>(pcmbuf.data(), nbytes),
+        numchannels, csize, n
+      );
+      MD5::Update(
+        &md5ctx, std::span<const std::uint8_t>(pcmbuf.data(), nbytes), nbytes
+      );
+      samplestested += n;
+      PrintProgress(samplestested, mySac.getNumSamples());
+    }
+    if(!next_batch.valid()) { break; }
+    nframes = next_batch.get();
+    std::swap(frames, frames_next);
+  }
+  return badframes;
 }
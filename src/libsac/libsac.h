@@ -40,6 +40,7 @@ public:
     std::int32_t optk = 4;
     SearchMethod optimize_search = SearchMethod::DDS;
     SearchCost optimize_cost = SearchCost::Entropy;
+    std::int32_t warm_start = 0; // evaluate from a warmed-up predictor
   };
 
   struct tsac_cfg {
@@ -49,8 +50,15 @@ public:
     std::int32_t max_framelen = 20;
     std::int32_t verbose_level = 0;
     std::int32_t stereo_ms = 0;
-    std::int32_t mt_mode = 2;
+    std::int32_t mt_mode = 2; // 3: stereo predictors on two threads
     std::int32_t adapt_block = 1;
+    std::int32_t frame_threads = 1; // number of frames coded in parallel
+    std::int32_t seek_table = 1;    // append frame index for random access
+    std::int32_t decode_start = 0;  // sample range to decode,
+    std::int32_t decode_end = -1;   // -1 decodes until the end
+    std::int32_t frame_crc = 1;     // store a crc per channel and frame
+    std::int32_t fast_ols = 0;      // approximate ols solver, see OLS::SolveGS
+    std::int32_t lms_f32 = 0;       // single precision nlms cascade
 
     toptim_cfg ocfg;
     SacProfile profiledata;
@@ -64,20 +72,31 @@ public:
 
   std::int32_t GetNumSamples() const { return numsamples_; };
 
+  const SacProfile& GetProfile() const { return base_profile; };
+
+  void SetProfile(const SacProfile& profile) { base_profile = profile; };
+
   void Predict();
   void Unpredict();
+  bool VerifyCRC(std::int32_t ch) const;
   void Encode();
   void Decode();
-  void WriteEncoded(AudioFile<AudioFileBase::Mode::Write>& fout);
+  void WriteEncoded(std::vector<std::uint8_t>& buf);
   void ReadEncoded(AudioFile<AudioFileBase::Mode::Read>& fin);
   std::vector<std::vector<std::int32_t>> samples, error, s2u_error,
     s2u_error_map, pred;
   std::vector<BufIO> encoded, enc_temp1, enc_temp2;
   std::vector<SacProfile::FrameStats> framestats;
 
+  // fixed part, followed by the optional crc
+  static constexpr std::int32_t BLOCK_HEADER_SIZE = 18;
+  static constexpr std::int32_t BLOCK_CRC_SIZE = 4;
+  // flag bits no reader knows yet, the block can't be decoded
+  static constexpr std::uint16_t BLOCK_FLAGS_UNKNOWN = 0xe000U;
+  // returns the header size, -1 if the block uses unknown flags
   static std::int32_t WriteBlockHeader(
-    std::fstream& file, const std::vector<SacProfile::FrameStats>& framestats,
-    std::int32_t ch
+    std::span<std::uint8_t> buf,
+    const std::vector<SacProfile::FrameStats>& framestats, std::int32_t ch
   );
   static std::int32_t ReadBlockHeader(
     std::fstream& file, std::vector<SacProfile::FrameStats>& framestats,
@@ -117,7 +136,25 @@ private:
     const SacProfile& profile, tch_samples& error, std::int32_t from,
     std::int32_t numsamples, bool optimize
   );
+  // optimizer evaluation resumed from a predictor snapshot taken at from,
+  // cold start if the snapshot does not fit the profile
+  void PredictFrame(
+    const SacProfile& profile, std::span<const std::uint8_t> state,
+    tch_samples& error, std::int32_t from, std::int32_t numsamples
+  );
   void UnpredictFrame(const SacProfile& profile, std::int32_t numsamples);
+  // sample loops, instantiated per predictor specialization
+  // the first skip samples are history only, error starts at index skip
+  template<typename TPredictor>
+  void PredictFrame(
+    TPredictor& pr, const Predictor::tparam& param, tch_samples& error,
+    std::int32_t from, std::int32_t numsamples, bool optimize,
+    std::int32_t skip = 0
+  );
+  template<typename TPredictor>
+  void UnpredictFrame(
+    TPredictor& pr, const Predictor::tparam& param, std::int32_t numsamples
+  );
   double CalcRemapError(std::int32_t ch, std::int32_t numsamples);
   void EncodeMonoFrame(std::int32_t ch, std::int32_t numsamples);
   void DecodeMonoFrame(std::int32_t ch, std::int32_t numsamples);
@@ -152,8 +189,21 @@ public:
     Wav<AudioFileBase::Mode::Write>& myWav
   );
   static void ScanFrames(Sac<AudioFileBase::Mode::Read>& mySac);
+  std::int32_t TestFile(
+    Sac<AudioFileBase::Mode::Read>& mySac, MD5::MD5Context& md5ctx
+  );
 
 private:
+  using tframes = std::vector<std::unique_ptr<FrameCoder>>;
+
+  static std::int32_t SeekFrame(
+    Sac<AudioFileBase::Mode::Read>& mySac, FrameCoder& frame,
+    std::int32_t sample
+  );
+
+  tframes CreateFrames(std::int32_t numchannels, std::int32_t framesize) const;
+  template<typename F>
+  static void RunFrames(tframes& frames, std::size_t nframes, F func);
   std::vector<Codec::tsub_frame> Analyse(
     const std::vector<std::vector<std::int32_t>>& samples,
     std::int32_t blocksamples, std::int32_t min_frame_length,
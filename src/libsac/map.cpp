@@ -5,10 +5,7 @@
 #include <cstdint>
 #include <iostream>
 
-MapEncoder::MapEncoder(
-  RangeCoderSH& rc, std::vector<bool>& usedl, std::vector<bool>& usedh
-):
-  rc(rc),
+MapEncoder::MapEncoder(std::vector<bool>& usedl, std::vector<bool>& usedh):
   mixl(4, NMixLogistic(5)),
   mixh(4, NMixLogistic(5)),
   finalmix(2),
@@ -41,8 +38,7 @@ std::int32_t MapEncoder::PredictLow(std::size_t i) {
   px = &cctx[sctx];
 
   mix = &mixl[ctx1 + (ctx3 << 1U)];
-  std::vector<std::int32_t> p = {pc1->p1, pc2->p1, pc3->p1, pc4->p1, px->p1};
-  return mix->Predict(p);
+  return mix->Predict({pc1->p1, pc2->p1, pc3->p1, pc4->p1, px->p1});
 }
 
 std::int32_t MapEncoder::PredictHigh(std::size_t i) {
@@ -70,8 +66,7 @@ std::int32_t MapEncoder::PredictHigh(std::size_t i) {
   }
   px = &cctx[32 + sctx];
   mix = &mixh[ctx1 + (ctx3 << 1U)];
-  std::vector<std::int32_t> p = {pc1->p1, pc2->p1, pc3->p1, pc4->p1, px->p1};
-  return mix->Predict(p);
+  return mix->Predict({pc1->p1, pc2->p1, pc3->p1, pc4->p1, px->p1});
 }
 
 void MapEncoder::Update(std::int32_t bit) {
@@ -84,8 +79,7 @@ void MapEncoder::Update(std::int32_t bit) {
 }
 
 std::int32_t MapEncoder::PredictSSE(std::int32_t p1, std::int32_t ctx) {
-  std::vector<std::int32_t> vp = {sse[ctx].Predict(p1), p1};
-  return finalmix.Predict(vp);
+  return finalmix.Predict({sse[ctx].Predict(p1), p1});
 }
 
 void MapEncoder::UpdateSSE(std::int32_t bit, std::int32_t ctx) {
@@ -93,35 +87,38 @@ void MapEncoder::UpdateSSE(std::int32_t bit, std::int32_t ctx) {
   finalmix.Update(bit, mixsse_upd_rate);
 }
 
-void MapEncoder::Encode() {
+template<typename Coder> void MapEncoder::Encode(Coder& coder) {
   for(std::size_t i = 1; i <= 1U << 15U; i++) {
     std::int32_t bit = static_cast<std::int32_t>(ul[i]);
 
-    rc.EncodeBitOne(PredictSSE(PredictLow(i), 0), bit);
+    coder.EncodeBitOne(PredictSSE(PredictLow(i), 0), bit);
     Update(bit);
     UpdateSSE(bit, 0);
 
     bit = static_cast<std::int32_t>(uh[i]);
-    rc.EncodeBitOne(PredictSSE(PredictHigh(i), 0), bit);
+    coder.EncodeBitOne(PredictSSE(PredictHigh(i), 0), bit);
     Update(bit);
     UpdateSSE(bit, 0);
   }
 }
 
-void MapEncoder::Decode() {
+template<typename Coder> void MapEncoder::Decode(Coder& coder) {
   for(std::size_t i = 1; i <= 1U << 15U; i++) {
-    std::int32_t bit = rc.DecodeBitOne(PredictSSE(PredictLow(i), 0));
+    std::int32_t bit = coder.DecodeBitOne(PredictSSE(PredictLow(i), 0));
     Update(bit);
     ul[i] = (bit != 0);
     UpdateSSE(bit, 0);
 
-    bit = rc.DecodeBitOne(PredictSSE(PredictHigh(i), 0));
+    bit = coder.DecodeBitOne(PredictSSE(PredictHigh(i), 0));
     Update(bit);
     uh[i] = (bit != 0);
     UpdateSSE(bit, 0);
   }
 }
 
+template void MapEncoder::Encode(RangeCoderSH&);
+template void MapEncoder::Decode(RangeCoderSH&);
+
 Remap::Remap(): scale(1U << 15U), usedl(scale + 1), usedh(scale + 1) {}
 
 void Remap::Reset() {
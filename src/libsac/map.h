@@ -16,11 +16,10 @@ class MapEncoder {
   static constexpr std::int32_t mixsse_upd_rate = 500;
 
 public:
-  MapEncoder(
-    RangeCoderSH& rc, std::vector<bool>& usedl, std::vector<bool>& usedh
-  );
-  void Encode();
-  void Decode();
+  MapEncoder(std::vector<bool>& usedl, std::vector<bool>& usedh);
+  // Coder as in BitplaneCoder, instantiated in map.cpp
+  template<typename Coder> void Encode(Coder& coder);
+  template<typename Coder> void Decode(Coder& coder);
 
 private:
   std::int32_t PredictLow(std::size_t i);
@@ -28,7 +27,6 @@ private:
   void Update(std::int32_t bit);
   std::int32_t PredictSSE(std::int32_t p1, std::int32_t ctx);
   void UpdateSSE(std::int32_t bit, std::int32_t ctx);
-  RangeCoderSH& rc;
   std::array<LinearCounter16, 24> cnt;
   std::array<LinearCounter16, 256> cctx;
   LinearCounter16 *pc1, *pc2, *pc3, *pc4, *px;
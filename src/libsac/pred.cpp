@@ -2,75 +2,108 @@
 
 #include <cassert>
 
-Predictor::Predictor(const tparam& p):
+template<PredictorBase::torders O> PredictorT<O>::PredictorT(const tparam& p):
   p(p),
   nA(p.nA),
   nB(p.nB),
   nM0(p.nM0),
   nS0(p.nS0),
   nS1(p.nS1),
-  ols{
-    OLS(
-      nA + nM0, p.k, p.lambda0, p.ols_nu0, p.beta_sum0, p.beta_pow0, p.beta_add0
-    ),
-    OLS(
-      nB + nS0 + nS1, p.k, p.lambda1, p.ols_nu1, p.beta_sum1, p.beta_pow1,
-      p.beta_add1
-    )
-  },
+  ols0(
+    nA + nM0, p.k, p.lambda0, p.ols_nu0, p.beta_sum0, p.beta_pow0, p.beta_add0,
+    p.fast_ols[0]
+  ),
+  ols1(
+    nB + nS0 + nS1, p.k, p.lambda1, p.ols_nu1, p.beta_sum1, p.beta_pow1,
+    p.beta_add1, p.fast_ols[1]
+  ),
   lms{
     Cascade(
       p.vn0, p.vmu0, p.vmudecay0, p.vpowdecay0, p.mu_mix0, p.mu_mix_beta0,
-      p.lm_n, p.lm_alpha
+      p.lm_n, p.lm_alpha, p.lms_f32[0]
     ),
     Cascade(
       p.vn1, p.vmu1, p.vmudecay1, p.vpowdecay1, p.mu_mix1, p.mu_mix_beta1,
-      p.lm_n, p.lm_alpha
+      p.lm_n, p.lm_alpha, p.lms_f32[1]
     )
   },
   be{
     BiasEstimator(p.bias_mu0, p.bias_scale0),
     BiasEstimator(p.bias_mu1, p.bias_scale1)
   } {
+  assert(!O.fixed() || O.matches(p));
   for(std::int32_t i = 0; i < 2; i++) { p_lpc[i] = p_lms[i] = 0.0; }
 }
 
-void Predictor::fillbuf_ch0(
+// the orders are compile-time constants in the specialized predictors
+template<PredictorBase::torders O>
+void PredictorT<O>::fillbuf_ch0(
   const std::int32_t* src0, std::int32_t idx0, const std::int32_t* src1,
   std::int32_t idx1
 ) {
-  vec1D& buf = ols[0].x;
+  const std::int32_t na = O.fixed() ? O.nA : nA;
+  const std::int32_t nm0 = O.fixed() ? O.nM0 : nM0;
+  auto& buf = ols0.x;
   std::int32_t bp = 0;
-  for(std::int32_t i = idx0 - nA; i < idx0; i++) {
+  for(std::int32_t i = idx0 - na; i < idx0; i++) {
     buf[bp++] = (i >= 0) ? src0[i] : 0.0;
   }
-  for(std::int32_t i = idx1 - nM0; i < idx1; i++) {
+  for(std::int32_t i = idx1 - nm0; i < idx1; i++) {
     buf[bp++] = (i >= 0) ? src1[i] : 0.0;
   }
 }
 
-void Predictor::fillbuf_ch1(
+template<PredictorBase::torders O>
+void PredictorT<O>::fillbuf_ch1(
   const std::int32_t* src0, const std::int32_t* src1, std::int32_t idx1,
   std::int32_t numsamples
 ) {
-  vec1D& buf = ols[1].x;
+  const std::int32_t nb = O.fixed() ? O.nB : nB;
+  const std::int32_t ns0 = O.fixed() ? O.nS0 : nS0;
+  const std::int32_t ns1 = O.fixed() ? O.nS1 : nS1;
+  auto& buf = ols1.x;
   std::int32_t bp = 0;
-  for(std::int32_t i = idx1 - nB; i < idx1; i++) {
+  for(std::int32_t i = idx1 - nb; i < idx1; i++) {
     buf[bp++] = (i >= 0) ? src1[i] : 0.0;
   }
-  for(std::int32_t i = idx1 - nS0; i < idx1 + nS1; i++) {
+  for(std::int32_t i = idx1 - ns0; i < idx1 + ns1; i++) {
     buf[bp++] = (i >= 0 && i < numsamples) ? src0[i] : 0.0;
   }
 }
 
-double Predictor::predict(std::int32_t ch) {
-  p_lpc[ch] = ols[ch].Predict();
+template<PredictorBase::torders O>
+double PredictorT<O>::predict(std::int32_t ch) {
+  p_lpc[ch] = (ch == 0) ? ols0.Predict() : ols1.Predict();
   p_lms[ch] = lms[ch].Predict();
   return be[ch].Predict(p_lpc[ch] + p_lms[ch]);
 }
 
-void Predictor::update(std::int32_t ch, double val) {
-  ols[ch].Update(val);
+template<PredictorBase::torders O>
+void PredictorT<O>::update(std::int32_t ch, double val) {
+  if(ch == 0) {
+    ols0.Update(val);
+  } else {
+    ols1.Update(val);
+  }
   lms[ch].Update(val - p_lpc[ch]);
   be[ch].Update(val);
 }
+
+template<PredictorBase::torders O>
+void PredictorT<O>::SaveState(std::vector<std::uint8_t>& buf) const {
+  State::Writer ar(buf);
+  const_cast<PredictorT*>(this)->Checkpoint(ar); // the writer only reads
+}
+
+template<PredictorBase::torders O>
+bool PredictorT<O>::LoadState(std::span<const std::uint8_t> buf) {
+  State::Reader check(buf, false);
+  Checkpoint(check);
+  if(!check.ok()) { return false; }
+  State::Reader ar(buf);
+  Checkpoint(ar);
+  return ar.ok();
+}
+
+template class PredictorT<PredictorBase::torders{}>;
+template class PredictorT<PredictorOrders::Default>;
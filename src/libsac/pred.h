@@ -1,13 +1,14 @@
 #ifndef PRED_H
 #define PRED_H
 
+#include "../common/state.h"
 #include "../pred/bias.h"
 #include "../pred/lms_cascade.h"
 #include "../pred/lpc.h"
 
 #include <array>
 
-class Predictor {
+class PredictorBase {
 public:
   struct tparam {
     std::int32_t nA, nB, nM0, nS0, nS1, k;
@@ -24,9 +25,29 @@ public:
     std::int32_t bias_scale0, bias_scale1;
     std::int32_t lm_n;
     double lm_alpha;
+    // per predictor channel, 0 is ch_ref
+    std::array<bool, 2> fast_ols;
+    std::array<bool, 2> lms_f32; // single precision nlms stages
   };
 
-  explicit Predictor(const tparam& p);
+  // ols orders fixed at compile time, nA < 0 leaves them to tparam
+  struct torders {
+    std::int32_t nA = -1, nB = -1, nM0 = -1, nS0 = -1, nS1 = -1;
+
+    constexpr bool fixed() const { return nA >= 0; }
+    constexpr std::int32_t n0() const { return fixed() ? nA + nM0 : 0; }
+    constexpr std::int32_t n1() const { return fixed() ? nB + nS0 + nS1 : 0; }
+    bool matches(const tparam& p) const {
+      return nA == p.nA && nB == p.nB && nM0 == p.nM0 && nS0 == p.nS0
+             && nS1 == p.nS1;
+    }
+  };
+};
+
+template<PredictorBase::torders O = PredictorBase::torders{}>
+class PredictorT: public PredictorBase {
+public:
+  explicit PredictorT(const tparam& p);
 
   double predict(std::int32_t ch);
   void update(std::int32_t ch, double val);
@@ -40,13 +61,54 @@ public:
     std::int32_t numsamples
   );
 
+  // snapshot of the adaptive state, appended to buf
+  void SaveState(std::vector<std::uint8_t>& buf) const;
+  // false and unchanged if the snapshot is from a different structure,
+  // the adaptation parameters of this predictor are kept
+  bool LoadState(std::span<const std::uint8_t> buf);
+  template<class Archive> void Checkpoint(Archive& ar) {
+    // the layout of the stages, equal sizes don't imply an equal tap order
+    ar.check(nA);
+    ar.check(nB);
+    ar.check(nM0);
+    ar.check(nS0);
+    ar.check(nS1);
+    ar.check(p.ch_ref);
+    ar.check(static_cast<std::uint64_t>(p.vn0.size()));
+    ar.check(static_cast<std::uint64_t>(p.vn1.size()));
+    for(const std::int32_t n: p.vn0) { ar.check(n); }
+    for(const std::int32_t n: p.vn1) { ar.check(n); }
+    ar.check(p.lm_n);
+    ar(ols0, ols1, lms, be, p_lpc, p_lms);
+  }
+
   tparam p;
   std::int32_t nA, nB, nM0, nS0, nS1;
 
-  std::array<OLS, 2> ols;
+  OLS<O.n0()> ols0;
+  OLS<O.n1()> ols1;
   std::array<Cascade, 2> lms;
   std::array<BiasEstimator, 2> be;
   std::array<double, 2> p_lpc, p_lms;
 };
 
+using Predictor = PredictorT<>;
+
+// orders with a specialized instantiation in pred.cpp
+namespace PredictorOrders {
+  inline constexpr PredictorBase::torders Default{16, 16, 0, 8, 8};
+
+  // calls func with the predictor specialized for param, or the generic one
+  template<typename F>
+  void Dispatch(const PredictorBase::tparam& param, F&& func) {
+    if(Default.matches(param)) {
+      PredictorT<Default> pr(param);
+      func(pr);
+    } else {
+      Predictor pr(param);
+      func(pr);
+    }
+  }
+} // namespace PredictorOrders
+
 #endif // PRED_H
@@ -67,7 +67,11 @@ public:
   struct FrameStats {
     std::int32_t maxbpn{}, maxbpn_map{};
     bool enc_mapped{};
+    bool fast_ols{}; // gauss-seidel instead of cholesky in the ols stage
+    bool lms_f32{};  // single precision nlms cascade
     std::int32_t blocksize{}, minval{}, maxval{}, mean{};
+    bool has_crc{};
+    std::uint32_t crc{}; // crc32c of the pcm samples
     Remap mymap;
   };
 
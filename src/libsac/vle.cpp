@@ -2,27 +2,69 @@
 
 #include "../common/math.h"
 
+#include <array>
+#include <bit>
 #include <cstddef>
+#include <mutex>
+
+namespace {
+  // spreads the 8 bits of v to the even bits of a 16-bit word,
+  // reversed=true takes them from the msb down
+  constexpr std::array<std::uint16_t, 256> make_spread(bool reversed) {
+    std::array<std::uint16_t, 256> tab{};
+    for(std::uint32_t v = 0; v < 256; v++) {
+      std::uint32_t r = 0;
+      for(std::uint32_t k = 0; k < 8; k++) {
+        const std::uint32_t b = reversed ? (v >> (7 - k)) & 1U : (v >> k) & 1U;
+        r |= b << (2 * k);
+      }
+      tab[v] = static_cast<std::uint16_t>(r);
+    }
+    return tab;
+  }
+  constexpr auto spread8 = make_spread(false);
+  constexpr auto spread8_rev = make_spread(true);
+} // namespace
 
+// table sizes follow the context ranges, see PredictSig/PredictRef/PredictSSE
 BitplaneCoder::BitplaneCoder(std::int32_t maxbpn, std::size_t numsamples):
-  csig0(1 << 20),
-  csig1(1 << 20),
-  csig2(1 << 20),
-  csig3(1 << 20),
-  cref0(1 << 20),
-  cref1(1 << 20),
-  cref2(1 << 20),
-  cref3(1 << 20),
+  csig0(1 << 16),
+  csig1(65),
+  cref0(32),
+  cref1(256),
+  cref2(64),
+  cref3(256),
   p_laplace(32),
-  lmixref(256, NMixLogistic(5)),
-  lmixsig(256, NMixLogistic(3)),
-  ssemix(2),
-  msb(numsamples),
-  maxbpn(maxbpn),
-  numsamples(numsamples),
-  lm(maxbpn)
+  lmixref(32, NMixLogistic(5)),
+  lmixsig(128, NMixLogistic(3)),
+  ssemix(2)
 // n_laplace(32),weights_laplace(2*n_laplace+1),
 {
+  for(std::int32_t i = 0; i < 32; i++) { bmask[i] = ~((1U << i) - 1); }
+  /*double s=35;
+  for (std::int32_t i=0;i<2*n_laplace+1;i++) {
+    std::int32_t idx=i-n_laplace;
+    weights_laplace[i]=1.0; //exp(-(idx*idx)/(s*s));
+  }*/
+  Reset(maxbpn, numsamples);
+}
+
+// back to the initial state, the tables keep their memory
+void BitplaneCoder::Reset(std::int32_t maxbpn, std::size_t numsamples) {
+  for(auto* tab : {&csig0, &csig1, &cref0, &cref1, &cref2, &cref3}) {
+    std::fill(tab->begin(), tab->end(), LinearCounterLimit());
+  }
+  for(auto& mix : lmixref) { mix.Init(0); }
+  for(auto& mix : lmixsig) { mix.Init(0); }
+  ssemix.Init(0);
+  for(auto& s : sse) { s = SSENL<15>(); }
+
+  this->maxbpn = maxbpn;
+  this->numsamples = static_cast<std::int32_t>(numsamples);
+  msb.assign(numsamples, 0);
+  sigmap.assign((numsamples + 2 * MAP_PAD) / 64 + 1, 0);
+  sigmap_prev.assign(sigmap.size(), 0);
+
   state = 0;
   bpn = 0;
   nrun = 0;
@@ -37,55 +79,92 @@ BitplaneCoder::BitplaneCoder(std::int32_t maxbpn, std::size_t numsamples):
       PSCALEm
     );
     // std::cout << p << ' ';
+    p_laplace[i] = LinearCounterLimit();
     p_laplace[i].p1 = p;
   }
   pestimate = 0;
-  for(std::int32_t i = 0; i < 32; i++) { bmask[i] = ~((1U << i) - 1); }
-  /*double s=35;
-  for (std::int32_t i=0;i<2*n_laplace+1;i++) {
-    std::int32_t idx=i-n_laplace;
-    weights_laplace[i]=1.0; //exp(-(idx*idx)/(s*s));
-  }*/
 }
 
+namespace {
+  std::mutex pool_mtx;
+  std::vector<std::unique_ptr<BitplaneCoder>> pool;
+} // namespace
+
+BitplaneCoderPool::Lease
+BitplaneCoderPool::Get(std::int32_t maxbpn, std::size_t numsamples) {
+  std::unique_ptr<BitplaneCoder> coder;
+  {
+    const std::lock_guard<std::mutex> lock(pool_mtx);
+    if(!pool.empty()) {
+      coder = std::move(pool.back());
+      pool.pop_back();
+    }
+  }
+  if(coder) {
+    coder->Reset(maxbpn, numsamples);
+  } else {
+    coder = std::make_unique<BitplaneCoder>(maxbpn, numsamples);
+  }
+  return Lease(std::move(coder));
+}
+
+void BitplaneCoderPool::Release(std::unique_ptr<BitplaneCoder> coder) {
+  const std::lock_guard<std::mutex> lock(pool_mtx);
+  pool.push_back(std::move(coder));
+}
+
+// count bits of map starting at sample pos, positions outside the frame
+// read as zero through the padding
+std::uint64_t BitplaneCoder::GetBits(
+  const std::vector<std::uint64_t>& map, std::int32_t pos, std::int32_t count
+) {
+  const std::uint32_t p = static_cast<std::uint32_t>(pos + MAP_PAD);
+  const std::uint32_t o = p & 63U;
+  std::uint64_t v = map[p >> 6U] >> o;
+  if(o != 0) { v |= map[(p >> 6U) + 1] << (64U - o); }
+  return count < 64 ? v & ((std::uint64_t{1} << count) - 1) : v;
+}
+
+void BitplaneCoder::SetSig(std::int32_t i) {
+  const std::uint32_t p = static_cast<std::uint32_t>(i + MAP_PAD);
+  sigmap[p >> 6U] |= std::uint64_t{1} << (p & 63U);
+}
+
+// significance of the sample (msb!=0) and its 8 neighbors on each side,
+// nctx bit 2k is sample i-k-1, bit 2k+1 is sample i+k+1
 void BitplaneCoder::GetSigState(std::int32_t i) {
-  sigst[0] = msb[i];
-  sigst[1] = i > 0 ? msb[i - 1] : 0;
-  sigst[2] = i < numsamples - 1 ? msb[i + 1] : 0;
-  sigst[3] = i > 1 ? msb[i - 2] : 0;
-  sigst[4] = i < numsamples - 2 ? msb[i + 2] : 0;
-  sigst[5] = i > 2 ? msb[i - 3] : 0;
-  sigst[6] = i < numsamples - 3 ? msb[i + 3] : 0;
-  sigst[7] = i > 3 ? msb[i - 4] : 0;
-  sigst[8] = i < numsamples - 4 ? msb[i + 4] : 0;
-  sigst[9] = i > 4 ? msb[i - 5] : 0;
-  sigst[10] = i < numsamples - 5 ? msb[i + 5] : 0;
-  sigst[11] = i > 5 ? msb[i - 6] : 0;
-  sigst[12] = i < numsamples - 6 ? msb[i + 6] : 0;
-  sigst[13] = i > 6 ? msb[i - 7] : 0;
-  sigst[14] = i < numsamples - 7 ? msb[i + 7] : 0;
-  sigst[15] = i > 7 ? msb[i - 8] : 0;
-  sigst[16] = i < numsamples - 8 ? msb[i + 8] : 0;
+  sig0 = GetBits(sigmap, i, 1) != 0;
+  nctx = spread8_rev[GetBits(sigmap, i - 8, 8)]
+         | (spread8[GetBits(sigmap, i + 1, 8)] << 1U);
 }
 
-std::uint32_t BitplaneCoder::GetAvgSum(std::int32_t n) {
-  std::uint64_t nsum = 0;
-  std::int32_t nidx = 0;
+// mean of the known magnitude in the window [sample-n,sample+n]
+// samples before the current one are coded down to bpn, the rest down to
+// bpn+1. both parts are running sums, set up by InitAvgSum at the start of
+// a bitplane and moved by UpdateAvgSum after each coded sample
+void BitplaneCoder::InitAvgSum(std::int32_t n) {
+  sum_l = sum_r = 0;
+  const std::int32_t end = std::min(n, numsamples - 1);
+  for(std::int32_t k = 0; k <= end; k++) {
+    sum_r += pabuf[k] & bmask[bpn + 1];
+  }
+}
 
+std::uint32_t BitplaneCoder::GetAvgSum(std::int32_t n) const {
   const std::int32_t start = std::max(sample - n, 0);
   const std::int32_t end = std::min(sample + n, numsamples - 1);
+  const std::uint64_t nidx = end - start + 1;
 
-  for(std::int32_t k = start; k < sample; k++) {
-    nsum += pabuf[k] & bmask[bpn];
-    nidx++;
-  }
+  return (sum_l + sum_r + nidx - 1) / nidx;
+}
 
-  for(std::int32_t k = sample; k <= end; k++) {
-    nsum += pabuf[k] & bmask[bpn + 1];
-    nidx++;
+void BitplaneCoder::UpdateAvgSum(std::int32_t n) {
+  sum_r -= pabuf[sample] & bmask[bpn + 1];
+  sum_l += pabuf[sample] & bmask[bpn];
+  if(sample - n >= 0) { sum_l -= pabuf[sample - n] & bmask[bpn]; }
+  if(sample + n + 1 < numsamples) {
+    sum_r += pabuf[sample + n + 1] & bmask[bpn + 1];
   }
-
-  return nidx > 0 ? (nsum + nidx - 1) / nidx : 0;
 }
 
 std::int32_t BitplaneCoder::PredictLaplace(std::uint32_t avg_sum) {
@@ -132,9 +211,11 @@ std::int32_t BitplaneCoder::PredictRef() {
   std::int32_t ctx1 = (b0 & 15) + ((b1 & 15) << 4) + ((b2 & 15) << 8);
   std::int32_t ctx2 =
     (c0 + (c1 << 1) + (c2 << 2) + (c3 << 3)) + (d0 << 4) + (d1 << 5);
-  std::int32_t ctx3 =
-    (sigst[1] + sigst[2] + sigst[3] + sigst[4] + sigst[5] + sigst[6] + sigst[7]
-     + sigst[8]);
+  std::int32_t ctx3 = 0;
+  for(std::int32_t k = 1; k <= 4; k++) {
+    if(sample - k >= 0) { ctx3 += msb[sample - k]; }
+    if(sample + k < numsamples) { ctx3 += msb[sample + k]; }
+  }
 
   pl = &p_laplace[bpn];
   pc1 = &cref0[msb[sample]];
@@ -161,27 +242,27 @@ void BitplaneCoder::UpdateRef(std::int32_t bit) {
   state = (state << 1) + 0;
 }
 
-// count number of significant samples in neighborhood
+// count number of significant samples in neighborhood, n<=64
+// n1: msb!=0, n2: msb>bpn (significant before this bitplane)
+// the last sample of the frame is not counted on the right side
 void BitplaneCoder::CountSig(
   std::int32_t n, std::int32_t& n1, std::int32_t& n2
 ) {
-  n1 = n2 = 0;
-  for(std::int32_t i = 1; i <= n; i++) {
-    if(sample - i >= 0) {
-      if(msb[sample - i]) n1 += 1;
-      if(msb[sample - i] > bpn) n2 += 1;
-    }
-    if(sample + i < numsamples - 1) {
-      if(msb[sample + i]) n1 += 1;
-      if(msb[sample + i] > bpn) n2 += 1;
-    }
+  std::uint64_t left = GetBits(sigmap, sample - n, n);
+  std::uint64_t right = GetBits(sigmap, sample + 1, n);
+  std::uint64_t left_prev = GetBits(sigmap_prev, sample - n, n);
+  std::uint64_t right_prev = GetBits(sigmap_prev, sample + 1, n);
+  if(sample < numsamples - 1 && sample + n >= numsamples - 1) {
+    const std::uint64_t last = ~(std::uint64_t{1} << (numsamples - 2 - sample));
+    right &= last;
+    right_prev &= last;
   }
+  n1 = std::popcount(left) + std::popcount(right);
+  n2 = std::popcount(left_prev) + std::popcount(right_prev);
 }
 
 std::int32_t BitplaneCoder::PredictSig() {
-  std::int32_t ctx1 = 0;
-  for(std::int32_t i = 0; i < 16; i++)
-    if(sigst[i + 1]) ctx1 += 1 << i;
+  std::int32_t ctx1 = static_cast<std::int32_t>(nctx);
 
   std::int32_t n1, n2;
   CountSig(32, n1, n2);
@@ -207,11 +288,10 @@ void BitplaneCoder::UpdateSig(std::int32_t bit) {
 }
 
 std::int32_t BitplaneCoder::PredictSSE(std::int32_t p1) {
-  std::int32_t ctx1 = ((pestimate >> 11) << 1) + (sigst[0] ? 1 : 0);
-  std::int32_t ctx2 = 32 + (sigst[0] ? 1 : 0) + ((sigst[1] ? 1 : 0) << 1)
-                      + ((sigst[2] ? 1 : 0) << 2) + ((sigst[3] ? 1 : 0) << 3)
-                      + ((sigst[4] ? 1 : 0) << 4) + ((sigst[5] ? 1 : 0) << 5)
-                      + ((sigst[6] ? 1 : 0) << 6);
+  std::int32_t ctx1 = ((pestimate >> 11) << 1) + (sig0 ? 1 : 0);
+  // sample and its 3 nearest neighbors on each side
+  std::int32_t ctx2 =
+    32 + (sig0 ? 1 : 0) + (static_cast<std::int32_t>(nctx & 63U) << 1);
   psse1 = &sse[ctx1];
   psse2 = &sse[ctx2];
   std::int32_t pr1 = psse1->Predict(p1);
@@ -225,57 +305,73 @@ void BitplaneCoder::UpdateSSE(std::int32_t bit) {
   ssemix.Update(bit, mixsse_upd_rate);
 }
 
-void BitplaneCoder::Encode(EncodeP1 encode_p1, std::int32_t* abuf) {
+template<typename Coder>
+void BitplaneCoder::Encode(Coder& coder, std::int32_t* abuf) {
   pabuf = abuf;
   for(bpn = maxbpn; bpn >= 0; bpn--) {
     state = 0;
+    sigmap_prev = sigmap;
+    InitAvgSum(32);
     for(sample = 0; sample < numsamples; sample++) {
       std::uint32_t avg_sum = GetAvgSum(32);
       pestimate = PredictLaplace(avg_sum); // lm.Predict(avg_sum,bpn);
       GetSigState(sample);
       std::int32_t bit = (pabuf[sample] >> bpn) & 1;
       std::int32_t p = 0;
-      if(sigst[0]) { // coef is significant, refine
+      if(sig0) { // coef is significant, refine
         p = PredictSSE(PredictRef());
-        encode_p1(p, bit);
+        coder.EncodeBitOne(p, bit);
         UpdateRef(bit);
         UpdateSSE(bit);
       } else { // coef is insignificant
         p = PredictSSE(PredictSig());
-        encode_p1(p, bit);
+        coder.EncodeBitOne(p, bit);
         UpdateSig(bit);
         UpdateSSE(bit);
-        if(bit) msb[sample] = bpn;
+        if(bit) {
+          msb[sample] = bpn;
+          if(bpn > 0) SetSig(sample);
+        }
       }
+      UpdateAvgSum(32);
     }
   }
 }
 
-void BitplaneCoder::Decode(DecodeP1 decode_p1, std::int32_t* buf) {
+template<typename Coder>
+void BitplaneCoder::Decode(Coder& coder, std::int32_t* buf) {
   std::int32_t bit;
   pabuf = buf;
   for(std::int32_t i = 0; i < numsamples; i++) buf[i] = 0;
   for(bpn = maxbpn; bpn >= 0; bpn--) {
     state = 0;
+    sigmap_prev = sigmap;
+    InitAvgSum(32);
     for(sample = 0; sample < numsamples; sample++) {
       std::uint32_t avg_sum = GetAvgSum(32);
       pestimate = PredictLaplace(avg_sum); // lm.Predict(avg_sum,bpn);
       GetSigState(sample);
-      if(sigst[0]) { // coef is significant, refine
-        bit = decode_p1(PredictSSE(PredictRef()));
+      if(sig0) { // coef is significant, refine
+        bit = coder.DecodeBitOne(PredictSSE(PredictRef()));
         UpdateRef(bit);
         UpdateSSE(bit);
         if(bit) buf[sample] += (1 << bpn);
       } else { // coef is insignificant
-        bit = decode_p1(PredictSSE(PredictSig()));
+        bit = coder.DecodeBitOne(PredictSSE(PredictSig()));
         UpdateSig(bit);
         UpdateSSE(bit);
         if(bit) {
           buf[sample] += (1 << bpn);
           msb[sample] = bpn;
+          if(bpn > 0) SetSig(sample);
         }
       }
+      UpdateAvgSum(32);
     }
   }
   for(std::int32_t i = 0; i < numsamples; i++) buf[i] = MathUtils::U2S(buf[i]);
 }
+
+template void BitplaneCoder::Encode(RangeCoderSH&, std::int32_t*);
+template void BitplaneCoder::Decode(RangeCoderSH&, std::int32_t*);
+template void BitplaneCoder::Encode(BitCostSink&, std::int32_t*);
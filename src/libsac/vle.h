@@ -2,11 +2,12 @@
 
 #include "../common/utils.h"
 #include "../model/counter.h"
+#include "../model/bitcost.h"
 #include "../model/mixer.h"
 #include "../model/range.h"
 #include "../model/sse.h"
 
-#include <functional>
+#include <memory>
 
 class StaticLaplaceModel {
 public:
@@ -34,9 +35,6 @@ private:
   std::vector<std::vector<std::int32_t>> pr;
 };
 
-using EncodeP1 = std::function<void(std::uint32_t, std::int32_t)>;
-using DecodeP1 = std::function<std::int32_t(std::uint32_t)>;
-
 class BitplaneCoder {
   const std::int32_t cnt_upd_rate_p = 150;
   const std::int32_t cnt_upd_rate_sig = 300;
@@ -48,12 +46,25 @@ class BitplaneCoder {
 
 public:
   BitplaneCoder(std::int32_t maxbpn, std::size_t numsamples);
-  void Encode(EncodeP1 encode_p1, std::int32_t* abuf);
-  void Decode(DecodeP1 decode_p1, std::int32_t* buf);
+  void Reset(std::int32_t maxbpn, std::size_t numsamples);
+  // Coder provides EncodeBitOne(p1,bit) / DecodeBitOne(p1), instantiated
+  // in vle.cpp
+  template<typename Coder> void Encode(Coder& coder, std::int32_t* abuf);
+  template<typename Coder> void Decode(Coder& coder, std::int32_t* buf);
+  // staging for callers that have to convert their input first,
+  // kept with the coder when it goes back to the pool
+  std::vector<std::int32_t>& InputBuffer(std::size_t n) {
+    inbuf.resize(n);
+    return inbuf;
+  }
 
 private:
   void CountSig(std::int32_t n, std::int32_t& n1, std::int32_t& n2);
   void GetSigState(std::int32_t i); // get actual significance state
+  static std::uint64_t GetBits(
+    const std::vector<std::uint64_t>& map, std::int32_t pos, std::int32_t count
+  );
+  void SetSig(std::int32_t i);
   std::int32_t PredictLaplace(std::uint32_t avg_sum);
   std::int32_t PredictRef();
   void UpdateRef(std::int32_t bit);
@@ -61,28 +72,61 @@ private:
   void UpdateSig(std::int32_t bit);
   std::int32_t PredictSSE(std::int32_t p1);
   void UpdateSSE(std::int32_t bit);
-  std::uint32_t GetAvgSum(std::int32_t n);
+  void InitAvgSum(std::int32_t n);
+  std::uint32_t GetAvgSum(std::int32_t n) const;
+  void UpdateAvgSum(std::int32_t n);
 
-  std::vector<LinearCounterLimit> csig0, csig1, csig2, csig3, cref0, cref1,
-    cref2, cref3;
+  std::vector<LinearCounterLimit> csig0, csig1, cref0, cref1, cref2, cref3;
   std::vector<LinearCounterLimit> p_laplace;
   std::vector<NMixLogistic> lmixref, lmixsig;
   NMixLogistic ssemix;
 
-  SSENL<15> sse[1 << 12];
+  SSENL<15> sse[160];
   SSENL<15>*psse1, *psse2;
   LinearCounterLimit *pc1, *pc2, *pc3, *pc4;
   LinearCounterLimit* pl;
   NMixLogistic* plmix;
   std::int32_t *pabuf, sample;
   std::vector<std::int32_t> msb;
+  // msb!=0 as a bitmap, sample i at bit i+MAP_PAD, and its state at the
+  // start of the current bitplane (msb>bpn)
+  static constexpr std::int32_t MAP_PAD = 64;
+  std::vector<std::uint64_t> sigmap, sigmap_prev;
+  bool sig0;
+  std::uint32_t nctx;
   // std::int32_t n_laplace;
   // std::vector <double>weights_laplace;
-  std::int32_t sigst[17];
   std::uint32_t bmask[32];
+  std::uint64_t sum_l, sum_r; // running sums of GetAvgSum
   std::int32_t maxbpn, bpn, numsamples, nrun, pestimate;
   std::uint32_t state;
-  StaticLaplaceModel lm;
+  std::vector<std::int32_t> inbuf;
+};
+
+// coders are returned to a shared free list when a lease ends and reset
+// on the next Get, so frames and optimizer evaluations reuse the tables
+class BitplaneCoderPool {
+public:
+  class Lease {
+  public:
+    explicit Lease(std::unique_ptr<BitplaneCoder> coder):
+      coder(std::move(coder)) {}
+    Lease(Lease&&) = default;
+    Lease& operator=(Lease&&) = delete;
+    ~Lease() {
+      if(coder) { Release(std::move(coder)); }
+    }
+
+    BitplaneCoder* operator->() const { return coder.get(); }
+
+  private:
+    std::unique_ptr<BitplaneCoder> coder;
+  };
+
+  static Lease Get(std::int32_t maxbpn, std::size_t numsamples);
+
+private:
+  static void Release(std::unique_ptr<BitplaneCoder> coder);
 };
 
 class Golomb {
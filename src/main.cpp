@@ -4,8 +4,10 @@
 
 std::int32_t main(std::int32_t argc, const char* argv[]) {
   Shell Shell;
-  Shell::SACInfo();
   std::int32_t error = Shell.Parse(std::span<const char*>(argv, argc));
-  if(error == 0) { error = Shell.Process(); }
+  if(error == 0) {
+    Shell::SACInfo();
+    error = Shell.Process();
+  }
   return error;
 }
\ No newline at end of file
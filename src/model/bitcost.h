@@ -0,0 +1,33 @@
+#pragma once // BITCOST_H
+
+#include "model.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+// cost-only replacement for the range coder, sums the information content
+// -log2(p) of every coded bit instead of producing bytes
+class BitCostSink {
+public:
+  void EncodeBitOne(std::uint32_t p1, std::int32_t bit) {
+    nbits += (bit != 0) ? tab[p1] : tab[PSCALE - p1];
+  }
+
+  double Bits() const { return nbits; }
+  double Bytes() const { return nbits / 8.0; }
+
+private:
+  // tab[p] = -log2(p/PSCALE)
+  static std::array<double, PSCALE> make_table() {
+    std::array<double, PSCALE> t{};
+    t[0] = PBITS + 1.0; // p1 is clamped to [1,PSCALEm], never read
+    for(std::int32_t p = 1; p < PSCALE; p++) {
+      t[p] = -std::log2(static_cast<double>(p) / static_cast<double>(PSCALE));
+    }
+    return t;
+  }
+
+  static inline const std::array<double, PSCALE> tab = make_table();
+  double nbits{0.0};
+};
@@ -5,6 +5,8 @@
 #include "model.h"
 
 #include <algorithm>
+#include <initializer_list>
+#include <span>
 #include <vector>
 
 // adaptive linear 2-input mix
@@ -84,7 +86,12 @@ public:
     for(std::int32_t i = 0; i < n; i++) w[i] = iw;
   };
 
-  std::int32_t Predict(const std::vector<std::int32_t>& p) {
+  std::int32_t Predict(std::initializer_list<std::int32_t> p) {
+    return Predict(std::span<const std::int32_t>(p.begin(), p.size()));
+  }
+
+  // p holds at least n inputs
+  std::int32_t Predict(std::span<const std::int32_t> p) {
     std::int64_t sum = 0;
     for(std::int32_t i = 0; i < n; i++) {
       x[i] = myDomain.Fwd(p[i]);
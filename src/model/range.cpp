@@ -61,22 +61,6 @@ void RangeCoderSH::Stop()
   if (decode==0) for (std::uint32_t _=0;_<NUM+1;_++) ShiftLow();
 }
 
-void RangeCoderSH::EncodeBitOne(std::uint32_t p1,std::int32_t bit)
-{
-  const std::uint32_t rnew = SCALE_RANGE(range, p1);
-  bit ? range-=rnew, lowc+=rnew : range=rnew;
-  while(range<TOP) range<<=8,ShiftLow();
-}
-
-std::int32_t RangeCoderSH::DecodeBitOne(std::uint32_t p1)
-{
-  const std::uint32_t rnew = SCALE_RANGE(range, p1);
-  std::int32_t bit = (code>=rnew);
-  bit ? range-=rnew, code-=rnew : range=rnew;
-  while(range<TOP) range<<=8,(code<<=8)+=buf.GetByte();
-  return bit;
-}
-
 void RangeCoderSH::ShiftLow()
 {
   std::uint32_t Carry = std::uint32_t(lowc>>32), low = std::uint32_t(lowc);
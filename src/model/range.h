@@ -4,7 +4,6 @@
 #include "model.h"
 
 #include <cstdint>
-#include <functional>
 
 class RangeCoderBase {
 public:
@@ -91,16 +90,35 @@ public:
   using RangeCoderBase::RangeCoderBase;
   void Init();
   void Stop();
-  void EncodeBitOne(std::uint32_t p1, std::int32_t bit);
-  std::int32_t DecodeBitOne(std::uint32_t p1);
-
-  std::function<void(std::uint32_t, std::int32_t)> encode_p1 =
-    [this](std::uint32_t p1, std::int32_t bit) {
-      EncodeBitOne(p1, bit);
-      return;
-    }; // stupid C++
-  std::function<std::int32_t(std::uint32_t)> decode_p1 =
-    [this](std::uint32_t p1) { return DecodeBitOne(p1); };
+  // inline, the bit models call these once per coded bit
+  void EncodeBitOne(std::uint32_t p1, std::int32_t bit) {
+    const std::uint32_t rnew = SCALE_RANGE(range, p1);
+    if(bit != 0) {
+      range -= rnew;
+      lowc += rnew;
+    } else {
+      range = rnew;
+    }
+    while(range < TOP) {
+      range <<= 8;
+      ShiftLow();
+    }
+  }
+  std::int32_t DecodeBitOne(std::uint32_t p1) {
+    const std::uint32_t rnew = SCALE_RANGE(range, p1);
+    const std::int32_t bit = (code >= rnew) ? 1 : 0;
+    if(bit != 0) {
+      range -= rnew;
+      code -= rnew;
+    } else {
+      range = rnew;
+    }
+    while(range < TOP) {
+      range <<= 8;
+      (code <<= 8) += buf.GetByte();
+    }
+    return bit;
+  }
 
 protected:
   void ShiftLow();
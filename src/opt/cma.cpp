@@ -23,7 +23,7 @@ auto OptCMA::generate_candidate(const vec1D &x,double sigma)
   for (auto &r:z)
     r = rand.r_norm();
 
-  vec1D az=MathUtils::mul(chol.G,z);
+  vec1D az=chol.MulLower(z);
 
   vec1D xgen(ndim);
   for (std::int32_t i=0;i<ndim;i++)
@@ -4,6 +4,8 @@
 #include "../common/utils.h"
 #include "lms.h"
 
+#include <array>
+
 constexpr bool BIAS_ROUND_PRED = true;
 constexpr std::int32_t BIAS_MIX_N = 3;
 constexpr std::int32_t BIAS_MIX_NUMCTX = 4;
@@ -47,6 +49,10 @@ class BiasEstimator {
           bias.cnt>>=1;
         }
       }
+      template <class Archive>
+      void Checkpoint(Archive &ar) {
+        ar(bias.cnt,bias.val);
+      }
     private:
       const std::int32_t nscale;
       bias_cnt bias;
@@ -123,7 +129,7 @@ class BiasEstimator {
 
       CalcContext(pred);
 
-      vec1D pb(BIAS_MIX_N);
+      std::array<double,BIAS_MIX_N> pb;
       pb[0]=cnt0[ctx0].get();
       pb[1]=cnt1[ctx1].get();
       pb[2]=cnt2[ctx2].get();
@@ -159,6 +165,10 @@ class BiasEstimator {
           mix_ada[mix_ctx].w[i] = std::max(mix_ada[mix_ctx].w[i],0.);
       }
     }
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      ar(mix_ada,hist_input,hist_delta,ctx0,ctx1,ctx2,mix_ctx,px,cnt0,cnt1,cnt2,run_mv);
+    }
   private:
     using MixerType = decltype(createMixer(0.0)); // Deduce the mixer type
     std::vector<MixerType> mix_ada;
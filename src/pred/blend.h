@@ -26,6 +26,10 @@ class Blend2 {
       z = std::clamp(z,-scale,scale);
       w = 1.0 / (1.0 + std::exp(-z));
    }
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      ar(w,rsum);
+    }
   protected:
     double w,th0,th1,scale;
     RunSumEMA rsum;
@@ -1,69 +1,147 @@
 #pragma once // LMS_H
 
 #include <cmath>
+#include <type_traits>
 #include "../global.h"
 #include "../common/histbuf.h"
 #include "../common/utils.h"
 #include "../common/math.h"
 
+// history and weights are kept in T, double or float
+// derived streams provide a non-virtual Update(double)
+template <typename T>
 class LS_Stream {
   public:
     LS_Stream(std::int32_t n)
-    :n(n),x(n),w(n),pred(0.)
+    :n(n),x(n),w(n)
     {
 
     }
+    // prediction for the next sample, computed at the end of Update
     double Predict() {
-      pred = MathUtils::dot_scalar(span_cf64(x.data(), n),span_cf64(w.data(), n));
       return pred;
     }
-    virtual void Update(double val)=0;
-    virtual ~LS_Stream(){};
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      ar(x,w,pred);
+    }
   protected:
+    void PredictNext() {
+      if constexpr (std::is_same_v<T,double>) {
+        pred = MathUtils::dot_scalar(span_cf64(x.data(), n),span_cf64(w.data(), n));
+      } else {
+        T sum=0;
+        for (std::int32_t i=0;i<n;i++) sum+=x[i]*w[i];
+        pred = sum;
+      }
+    }
     std::int32_t n;
-    RollBuffer2<double>x;
-    std::vector<double,align_alloc<double>> w;
-    double pred;
+    RollBuffer2<T>x;
+    std::vector<T,align_alloc<T>> w;
+    double pred=0.;
 };
 
-class NLMS_Stream : public LS_Stream
+template <typename T>
+class NLMS_Stream : public LS_Stream<T>
 {
+  using LS_Stream<T>::n;
+  using LS_Stream<T>::x;
+  using LS_Stream<T>::w;
+  using LS_Stream<T>::pred;
   public:
     NLMS_Stream(std::int32_t n,double mu,double mu_decay=1.0,double pow_decay=0.8)
-    :LS_Stream(n),mutab(n),powtab(n),mu(mu)
+    :LS_Stream<T>(n),mutab(n),powtab(n),mu(mu)
     {
+      spow=0;
       sum_powtab=0;
       for (std::int32_t i=0;i<n;i++) {
-         powtab[i]=1.0/(std::pow(1+i,pow_decay));
+         powtab[i]=static_cast<T>(1.0/(std::pow(1+i,pow_decay)));
          sum_powtab+=powtab[i];
-         mutab[i]=std::pow(mu_decay,i);
+         mutab[i]=static_cast<T>(std::pow(mu_decay,i));
       }
     }
 
-    void Update(double val) override {
-      const double spow=MathUtils::calc_spow(x.get_span(), powtab);
-      const double wgrad=mu*(val-pred)*sum_powtab/(spow + SACGlobalCfg::NLMS_POW_EPS);
-      for (std::int32_t i=0;i<n;i++) {
-        w[i]+=mutab[i]*(wgrad*x[i]);
+    // single sweep over the taps: updates the weights with the old history,
+    // then predicts the next sample and its signal power from the new one
+    void Update(double val) {
+      const T wgrad=static_cast<T>(mu*(val-pred)*sum_powtab/(spow + SACGlobalCfg::NLMS_POW_EPS));
+      const T xlast=x[n-1];
+      x.push(static_cast<T>(val));
+      const T *xn=x.data(); // xn[i+1] is the old x[i]
+
+      T sum_pred=0,sum_pow=0;
+      std::int32_t i=0;
+#ifdef __AVX2__
+      if constexpr (std::is_same_v<T,double>) {
+        const __m256d vg=_mm256_set1_pd(wgrad);
+        __m256d vpred=_mm256_setzero_pd();
+        __m256d vpow=_mm256_setzero_pd();
+        for (;i+4<n;i+=4) {
+          const __m256d xo=_mm256_loadu_pd(xn+i+1);
+          const __m256d xv=_mm256_loadu_pd(xn+i);
+          const __m256d wv=_mm256_add_pd(_mm256_load_pd(&w[i]),_mm256_mul_pd(_mm256_load_pd(&mutab[i]),_mm256_mul_pd(vg,xo)));
+          _mm256_store_pd(&w[i],wv);
+          vpred=_mm256_add_pd(vpred,_mm256_mul_pd(wv,xv));
+          vpow=_mm256_add_pd(vpow,_mm256_mul_pd(_mm256_load_pd(&powtab[i]),_mm256_mul_pd(xv,xv)));
+        }
+        sum_pred=hsum(vpred);
+        sum_pow=hsum(vpow);
+      } else {
+        const __m256 vg=_mm256_set1_ps(wgrad);
+        __m256 vpred=_mm256_setzero_ps();
+        __m256 vpow=_mm256_setzero_ps();
+        for (;i+8<n;i+=8) {
+          const __m256 xo=_mm256_loadu_ps(xn+i+1);
+          const __m256 xv=_mm256_loadu_ps(xn+i);
+          const __m256 wv=_mm256_add_ps(_mm256_load_ps(&w[i]),_mm256_mul_ps(_mm256_load_ps(&mutab[i]),_mm256_mul_ps(vg,xo)));
+          _mm256_store_ps(&w[i],wv);
+          vpred=_mm256_add_ps(vpred,_mm256_mul_ps(wv,xv));
+          vpow=_mm256_add_ps(vpow,_mm256_mul_ps(_mm256_load_ps(&powtab[i]),_mm256_mul_ps(xv,xv)));
+        }
+        sum_pred=hsum(vpred);
+        sum_pow=hsum(vpow);
       }
-      x.push(val);
+#endif
+      for (;i<n;i++) {
+        const T xo=(i+1<n)?xn[i+1]:xlast;
+        w[i]+=mutab[i]*(wgrad*xo);
+        sum_pred+=w[i]*xn[i];
+        sum_pow+=powtab[i]*(xn[i]*xn[i]);
+      }
+      pred=sum_pred;
+      spow=sum_pow;
     };
-    ~NLMS_Stream() override {} ;
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      LS_Stream<T>::Checkpoint(ar);
+      ar(spow);
+    }
   protected:
-    std::vector<double,align_alloc<double>> mutab,powtab;
-    double sum_powtab;
+#ifdef __AVX2__
+    static double hsum(__m256d v) {
+      const __m128d s=_mm_add_pd(_mm256_castpd256_pd128(v),_mm256_extractf128_pd(v,1));
+      return _mm_cvtsd_f64(_mm_add_sd(s,_mm_unpackhi_pd(s,s)));
+    }
+    static float hsum(__m256 v) {
+      __m128 s=_mm_add_ps(_mm256_castps256_ps128(v),_mm256_extractf128_ps(v,1));
+      s=_mm_add_ps(s,_mm_movehl_ps(s,s));
+      return _mm_cvtss_f32(_mm_add_ss(s,_mm_movehdup_ps(s)));
+    }
+#endif
+    std::vector<T,align_alloc<T>> mutab,powtab;
+    double spow,sum_powtab;
     double mu;
 };
 
-class LADADA_Stream : public LS_Stream
+class LADADA_Stream : public LS_Stream<double>
 {
   public:
     LADADA_Stream(std::int32_t n,double mu,double beta=0.97)
-    :LS_Stream(n),eg(n),mu(mu),beta(beta)
+    :LS_Stream<double>(n),eg(n),mu(mu),beta(beta)
     {
 
     }
-    void Update(double val) override
+    void Update(double val)
     {
       const double serr=MathUtils::sgn(val-pred); // prediction error
       for (std::int32_t i=0;i<n;i++) {
@@ -73,21 +151,27 @@ class LADADA_Stream : public LS_Stream
         w[i]+=mu*g;
       }
       x.push(val);
+      PredictNext();
+    }
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      LS_Stream<double>::Checkpoint(ar);
+      ar(eg);
     }
   protected:
     vec1D eg;
     double mu,beta;
 };
 
-class LMSADA_Stream : public LS_Stream
+class LMSADA_Stream : public LS_Stream<double>
 {
   public:
     LMSADA_Stream(std::int32_t n,double mu,double beta=0.97,double nu=0.0)
-    :LS_Stream(n),eg(n),mu(mu),beta(beta),nu(nu)
+    :LS_Stream<double>(n),eg(n),mu(mu),beta(beta),nu(nu)
     {
 
     }
-    void Update(double val) override
+    void Update(double val)
     {
       const double err=val-pred; // prediction error
       for (std::int32_t i=0;i<n;i++) {
@@ -97,6 +181,12 @@ class LMSADA_Stream : public LS_Stream
         w[i]+=mu*g;
       }
       x.push(val);
+      PredictNext();
+    }
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      LS_Stream<double>::Checkpoint(ar);
+      ar(eg);
     }
   protected:
     vec1D eg;
@@ -111,13 +201,15 @@ class LMS {
     :n(n),x(n),w(n),mu(mu),pred(0)
     {
     }
-    double Predict(const vec1D &inp) {
-      x = inp;
+    double Predict(span_cf64 inp) {
+      std::copy_n(inp.begin(), n, x.begin());
       pred = MathUtils::dot_scalar(span_cf64(w.data(), n), span_cf64(x.data(), n));
       return pred;
     }
-    virtual void Update(double)=0;
-    virtual ~LMS(){};
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      ar(x,w,pred);
+    }
     std::int32_t n;
     vec1D x,w;
   protected:
@@ -131,7 +223,7 @@ class LMS_ADA : public LMS
     :LMS(n,mu),eg(n),beta(beta),nu(nu)
     {
     }
-    void Update(double val) override {
+    void Update(double val) {
       const double err=val-pred; // prediction error
       for (std::int32_t i=0;i<n;i++) {
         double const grad=err*x[i] - nu*MathUtils::sgn(w[i]); // gradient + l1-regularization
@@ -141,6 +233,11 @@ class LMS_ADA : public LMS
         w[i]+=mu*g;
       }
     }
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      LMS::Checkpoint(ar);
+      ar(eg);
+    }
   protected:
     vec1D eg;
     double beta,nu;
@@ -153,7 +250,7 @@ class LAD_ADA : public LMS
     :LMS(n,mu),eg(n),beta(beta)
     {
     }
-    void Update(double val) override
+    void Update(double val)
     {
       const double serr=MathUtils::sgn(val-pred); // prediction error
       for (std::int32_t i=0;i<n;i++) {
@@ -163,6 +260,11 @@ class LAD_ADA : public LMS
         w[i]+=mu*scaled_grad;
       }
     }
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      LMS::Checkpoint(ar);
+      ar(eg);
+    }
   protected:
     vec1D eg;
     double beta;
@@ -190,7 +292,7 @@ class HBR_ADA : public LMS
       else
         return delta*MathUtils::sgn(err_g);
     }
-    void Update(double val) override {
+    void Update(double val) {
       const double err_g=val-pred; // prediction error
 
       double grad_loss = get_grad(err_g,delta);
@@ -201,6 +303,11 @@ class HBR_ADA : public LMS
         w[i]+=mu*g;
       }
     }
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      LMS::Checkpoint(ar);
+      ar(eg);
+    }
   protected:
     vec1D eg;
     double beta,delta;
@@ -216,7 +323,7 @@ class LMS_ADAM : public LMS
       power_beta11=beta1;
       power_beta2=1.0;
     }
-    void Update(double val) override {
+    void Update(double val) {
       power_beta1*=beta1;
       power_beta11*=beta1;
       power_beta2*=beta2;
@@ -234,6 +341,11 @@ class LMS_ADAM : public LMS
         w[i]+=mu*m_hat/(sqrt(n_hat)+SACGlobalCfg::LMS_ADA_EPS);
       }
     }
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      LMS::Checkpoint(ar);
+      ar(M,S,power_beta1,power_beta11,power_beta2);
+    }
   private:
     vec1D M,S;
     double beta1,beta2,power_beta1,power_beta11,power_beta2;
@@ -246,7 +358,7 @@ class SSLMS : public LMS {
       :LMS(n,mu)
       {
       }
-      void Update(double val) override
+      void Update(double val)
       {
         double e=val-pred;
         const double wf=mu*MathUtils::sgn(e);
@@ -5,6 +5,8 @@
 #include "blend.h"
 #include "../common/utils.h"
 
+#include <variant>
+
 /*
   double e0=std::abs(target-px0);
   double e1=(target-px1)*(target-px1);
@@ -39,7 +41,7 @@ class Blend2LMS_L1 {
     {
       return cw2.Predict(mix0.w[index],mix1.w[index]);
     }
-    double Predict(const vec1D &input)
+    double Predict(span_cf64 input)
     {
       px0=mix0.Predict(input);
       px1=mix1.Predict(input);
@@ -61,6 +63,10 @@ class Blend2LMS_L1 {
       double e1=std::abs(target-px1);
       cw2.Update(e0,e1);
     }
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      ar(px0,px1,mix0,mix1,cw2);
+    }
     std::int32_t n;
     double px0,px1;
     LAD_ADA mix0;
@@ -69,23 +75,28 @@ class Blend2LMS_L1 {
 };
 
 
+// nlms stages stored by value in one vector, double or float precision
 class Cascade {
+  template <typename T>
+  using tstages=std::vector<NLMS_Stream<T>>;
   public:
     Cascade(const std::vector<std::int32_t> &vn,const std::vector<double>&vmu,
                const std::vector<double>&vmudecay,const std::vector<double> &vpowdecay,
-               double mu_mix,double mu_mix_beta,std::int32_t lm_n,double lm_alpha)
+               double mu_mix,double mu_mix_beta,std::int32_t lm_n,double lm_alpha,
+               bool single=false)
     :n(vn.size()),p(n+1),
      mix(n+1,mu_mix,mu_mix_beta),
-     lm(lm_n,lm_alpha),
-     clms(n)
+     lm(lm_n,lm_alpha)
     {
-      for (std::int32_t i=0;i<n;i++)
-        clms[i]=new NLMS_Stream(vn[i],vmu[i],vmudecay[i],vpowdecay[i]);
+      if (single) clms=MakeStages<float>(vn,vmu,vmudecay,vpowdecay);
+      else clms=MakeStages<double>(vn,vmu,vmudecay,vpowdecay);
     }
     double Predict()
     {
-      for (std::int32_t i=0;i<n;i++)
-          p[i]=clms[i]->Predict();
+      std::visit([this](auto &stages) {
+        for (std::int32_t i=0;i<n;i++)
+          p[i]=stages[i].Predict();
+      },clms);
 
       p[n]=lm.Predict();
       return mix.Predict(p);
@@ -95,21 +106,37 @@ class Cascade {
       mix.UpdateMixer(target);
 
       double t=target;
-      for (std::int32_t i=0;i<n; i++) {
-        clms[i]->Update(t);
-        t-=mix.GetWeight(i)*p[i];
-      }
+      std::visit([this,&t](auto &stages) {
+        for (std::int32_t i=0;i<n; i++) {
+          stages[i].Update(t);
+          t-=mix.GetWeight(i)*p[i];
+        }
+      },clms);
       lm.UpdateHist(t);
       mix.UpdateBlend(target);
     }
-    ~Cascade()
-    {
-      for (std::int32_t i=0;i<n;i++) delete clms[i];
+    // the stage precision is structural, a snapshot only loads into a cascade of the same kind
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      ar.check(static_cast<std::uint32_t>(clms.index()));
+      std::visit([&ar](auto &stages) {ar(stages);},clms);
+      ar(p,mix,lm);
     }
   private:
+    template <typename T>
+    static tstages<T> MakeStages(const std::vector<std::int32_t> &vn,const std::vector<double>&vmu,
+                                 const std::vector<double>&vmudecay,const std::vector<double> &vpowdecay)
+    {
+      tstages<T> stages;
+      stages.reserve(vn.size());
+      for (std::size_t i=0;i<vn.size();i++)
+        stages.emplace_back(vn[i],vmu[i],vmudecay[i],vpowdecay[i]);
+      return stages;
+    }
+
     std::int32_t n;
     vec1D p;
     Blend2LMS_L1 mix;
     RLS lm;
-    std::vector<LS_Stream*> clms;
+    std::variant<tstages<double>,tstages<float>> clms;
 };
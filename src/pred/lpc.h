@@ -2,26 +2,31 @@
 
 #include "../common/utils.h"
 #include "../common/math.h"
+#include "../common/alignbuf.h"
 
 constexpr bool INIT_COV = false;
 
+// N > 0 fixes the order at compile time, n must match
+template <std::int32_t N=0>
 class OLS {
   public:
-    OLS(std::int32_t n,std::int32_t kmax=1,double lambda=0.998,double nu=0.001,double beta_sum=0.6,double beta_pow=0.75,double beta_add=2)
-    :x(n),
+    OLS(std::int32_t n,std::int32_t kmax=1,double lambda=0.998,double nu=0.001,double beta_sum=0.6,double beta_pow=0.75,double beta_add=2,bool fast=false)
+    :x(MathUtils::Cholesky::PaddedStride(n)),
     chol(n),
-    w(n),b(n),mcov(n,vec1D(n)),
-    n(n),kmax(kmax),lambda(lambda),nu(n*nu),
+    w(n),b(MathUtils::Cholesky::PaddedStride(n)),
+    mcov(static_cast<std::size_t>(n)*MathUtils::Cholesky::PaddedStride(n)),
+    n(n),stride(MathUtils::Cholesky::PaddedStride(n)),
+    kmax(kmax),fast(fast),lambda(lambda),nu(n*nu),
     beta_pow(beta_pow),beta_add(beta_add),esum(beta_sum)
     {
       km=0;
       pred=0.0;
       if constexpr (INIT_COV) {
-        for (std::int32_t i=0;i<n;i++) mcov[i][i]=1.0;
+        for (std::int32_t i=0;i<n;i++) mcov[i*stride+i]=1.0;
       }
     }
     double Predict() {
-      pred = MathUtils::dot_scalar(span_cf64(x.data(), n), span_cf64(w.data(), n));
+      pred = MathUtils::dot_scalar(span_cf64(x.data(), order()), span_cf64(w.data(), order()));
       return pred;
     }
 
@@ -31,24 +36,104 @@ class OLS {
       esum.Update(fabs(val-pred));
       double c0=std::pow(esum.Get()+beta_add,-beta_pow);
 
-      for (std::int32_t j=0;j<n;j++) {
-        // only update lower triangular
-        for (std::int32_t i=0;i<=j;i++) mcov[j][i]=lambda*mcov[j][i]+c0*(x[j]*x[i]);
-        b[j]=lambda*b[j]+c0*(x[j]*val);
-      }
+      UpdateCov(c0,val);
 
       km++;
       if (km>=kmax) {
-        if (!chol.Factor(mcov,nu)) chol.Solve(b,w);
+        if (fast) SolveGS();
+        else if (!chol.template Factor<N>(mcov,nu)) chol.template Solve<N>(span_cf64(b.data(),order()),w);
         km=0;
       }
     }
-    vec1D x;
+    // the factorization is rebuilt from mcov on the next solve
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      ar(x,w,b,mcov,km,pred,esum);
+    }
+    // padded to the row stride, the padding stays zero
+    std::vector<double,align_alloc<double>> x;
   protected:
+    std::int32_t order() const {
+      if constexpr (N>0) return N;
+      else return n;
+    }
+    std::int32_t row_stride() const {
+      if constexpr (N>0) return MathUtils::Cholesky::PaddedStride(N);
+      else return stride;
+    }
+    // rank-1 update of the lower triangle, mcov[j][i]=lambda*mcov[j][i]+c0*(x[j]*x[i])
+    // rows are processed in whole vectors, the entries right of the diagonal
+    // are updated too but never read
+    void UpdateCov(double c0,double val)
+    {
+      const std::int32_t nn=order();
+      const std::int32_t st=row_stride();
+      std::int32_t j=0;
+#if defined(__AVX512F__)
+      constexpr std::int32_t width=8;
+      const __m512d vl=_mm512_set1_pd(lambda);
+      const __m512d vc=_mm512_set1_pd(c0);
+      const __m512d vv=_mm512_set1_pd(val);
+      for (;j<st;j+=width) {
+        const __m512d xj=_mm512_load_pd(&x[j]);
+        const __m512d t=_mm512_mul_pd(vc,_mm512_mul_pd(xj,vv));
+        _mm512_store_pd(&b[j],_mm512_add_pd(_mm512_mul_pd(vl,_mm512_load_pd(&b[j])),t));
+      }
+      for (j=0;j<nn;j++) {
+        double *row=&mcov[j*st];
+        const __m512d xj=_mm512_set1_pd(x[j]);
+        for (std::int32_t i=0;i<=j;i+=width) {
+          const __m512d t=_mm512_mul_pd(vc,_mm512_mul_pd(xj,_mm512_load_pd(&x[i])));
+          _mm512_store_pd(row+i,_mm512_add_pd(_mm512_mul_pd(vl,_mm512_load_pd(row+i)),t));
+        }
+      }
+#elif defined(__AVX2__)
+      constexpr std::int32_t width=4;
+      const __m256d vl=_mm256_set1_pd(lambda);
+      const __m256d vc=_mm256_set1_pd(c0);
+      const __m256d vv=_mm256_set1_pd(val);
+      for (;j<st;j+=width) {
+        const __m256d xj=_mm256_load_pd(&x[j]);
+        const __m256d t=_mm256_mul_pd(vc,_mm256_mul_pd(xj,vv));
+        _mm256_store_pd(&b[j],_mm256_add_pd(_mm256_mul_pd(vl,_mm256_load_pd(&b[j])),t));
+      }
+      for (j=0;j<nn;j++) {
+        double *row=&mcov[j*st];
+        const __m256d xj=_mm256_set1_pd(x[j]);
+        for (std::int32_t i=0;i<=j;i+=width) {
+          const __m256d t=_mm256_mul_pd(vc,_mm256_mul_pd(xj,_mm256_load_pd(&x[i])));
+          _mm256_store_pd(row+i,_mm256_add_pd(_mm256_mul_pd(vl,_mm256_load_pd(row+i)),t));
+        }
+      }
+#else
+      for (;j<nn;j++) {
+        double *row=&mcov[j*st];
+        for (std::int32_t i=0;i<=j;i++) row[i]=lambda*row[i]+c0*(x[j]*x[i]);
+        b[j]=lambda*b[j]+c0*(x[j]*val);
+      }
+#endif
+    }
+    // one gauss-seidel sweep on (mcov+nu*I)w=b, warm started from the last w
+    // O(n^2) instead of the O(n^3) factorization, w converges over the samples
+    void SolveGS()
+    {
+      const std::int32_t nn=order();
+      const std::int32_t st=row_stride();
+      for (std::int32_t j=0;j<nn;j++) {
+        const double *row=&mcov[j*st];
+        double sum=b[j];
+        for (std::int32_t i=0;i<j;i++) sum-=row[i]*w[i];
+        for (std::int32_t i=j+1;i<nn;i++) sum-=mcov[i*st+j]*w[i];
+        const double d=row[j]+nu;
+        if (d>MathUtils::Cholesky::ftol) w[j]=sum/d;
+      }
+    }
+
     MathUtils::Cholesky chol;
-    vec1D w,b;
-    vec2D mcov;
-    std::int32_t n,kmax,km;
+    vec1D w;
+    std::vector<double,align_alloc<double>> b,mcov;
+    std::int32_t n,stride,kmax,km;
+    bool fast;
     double lambda,nu,pred;
     double beta_pow,beta_add;
     RunSumGEO esum;
@@ -7,12 +7,12 @@ constexpr std::int32_t RLS_ALC=1;
 RLS::RLS(std::int32_t n,double gamma,double nu)
 :n(n),
 px(0.),gamma(gamma),
-hist(n),w(n),
-P(n,vec1D(n)), // inverse covariance matrix
+hist(n),w(n),ph(n),
+P(static_cast<std::size_t>(n)*n), // inverse covariance matrix
 alc(gamma)
 {
   for (std::int32_t i=0;i<n;i++)
-    P[i][i]=1.0/nu;
+    P[i*n+i]=1.0/nu;
 }
 
 double RLS::Predict()
@@ -31,7 +31,8 @@ void RLS::Update(double val)
 {
   const double err=val-px;
 
-  vec1D ph=MathUtils::mul(P,hist); //phi=hist P hist
+  for (std::int32_t i=0;i<n;i++) //phi=hist P hist
+    ph[i]=MathUtils::dot_scalar(span_cf64(&P[i*n],n),hist);
   // a priori variance of prediction
   double phi=MathUtils::dot_scalar(hist,ph);
 
@@ -48,12 +49,16 @@ void RLS::Update(double val)
   //P(n)=1/lambda*P(n-1)-1/lambda * k(n)*x^T(n)*P(n-1)
   double denom=1./(alpha+phi);
   double inv_alpha=1.0/(alpha);
-  for (std::int32_t i=0;i<n;i++)
+  // P is symmetric, compute the lower triangle and mirror it
+  for (std::int32_t i=0;i<n;i++) {
+    double *pi=&P[i*n];
+    const double phi_i=ph[i];
     for (std::int32_t j=0;j<=i;j++) {
-      double m=ph[i]*ph[j]; // outer product of ph
-      double v=(P[i][j] - denom * m) * inv_alpha;
-      P[i][j] = P[j][i] = v;
+      double m=phi_i*ph[j]; // outer product of ph
+      double v=(pi[j] - denom * m) * inv_alpha;
+      pi[j] = P[j*n+i] = v;
     }
+  }
 
   // update weights
   for (std::int32_t i=0;i<n;i++)
@@ -3,6 +3,7 @@
 
 #include "../global.h"
 #include "../common/utils.h"
+#include "../common/alignbuf.h"
 #include <cmath>
 
 // adaptive lambda control
@@ -27,6 +28,10 @@ class ALC
       double m=miscUtils::decay_map<tmap_mode>(gamma,mnorm);
       return lambda_min + (lambda_max-lambda_min)*m;
     }
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      ar(msum);
+    }
   protected:
     double gamma,lambda_min,lambda_max;
     RunSum <> msum;
@@ -40,11 +45,17 @@ class RLS {
     double Predict(const vec1D &pred);
     void Update(double val);
     void UpdateHist(double val);
+    // ph is scratch and not part of the state
+    template <class Archive>
+    void Checkpoint(Archive &ar) {
+      ar(px,hist,w,P,alc);
+    }
     std::int32_t n;
   private:
     double px,gamma;
-    vec1D hist,w;
-    vec2D P;
+    vec1D hist,w,ph;
+    std::vector<double,align_alloc<double>> P; // n*n, row-major
+
     ALC<miscUtils::MapMode::exp> alc;
 };
 
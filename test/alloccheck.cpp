@@ -0,0 +1,67 @@
+// encodes and decodes a short generated stereo signal, built with
+// -DSAC_ALLOC_CHECK: any heap allocation in the sample loops of
+// PredictFrame/UnpredictFrame aborts
+#include "../src/libsac/libsac.h"
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace {
+  constexpr std::int32_t NUMSAMPLES = 16384;
+
+  // two correlated channels: sines plus deterministic noise
+  void GenerateSignal(FrameCoder& frame) {
+    std::uint32_t seed = 1;
+    for(std::int32_t i = 0; i < NUMSAMPLES; i++) {
+      seed = seed * 1664525U + 1013904223U;
+      const auto noise = static_cast<std::int32_t>(seed >> 24U) - 128;
+      const double t = static_cast<double>(i);
+      const auto l =
+        static_cast<std::int32_t>(8000.0 * std::sin(t * 0.031)) + noise;
+      const auto r =
+        static_cast<std::int32_t>(5000.0 * std::sin(t * 0.017 + 1.0)) + l / 2;
+      frame.samples[0][i] = l;
+      frame.samples[1][i] = r;
+    }
+    frame.SetNumSamples(NUMSAMPLES);
+  }
+
+  bool RoundTrip(std::int32_t mt_mode) {
+    FrameCoder::tsac_cfg cfg;
+    cfg.mt_mode = mt_mode;
+
+    FrameCoder enc(2, NUMSAMPLES, cfg);
+    GenerateSignal(enc);
+    const FrameCoder::tch_samples input = enc.samples;
+    enc.Predict();
+    enc.Encode();
+
+    FrameCoder dec(2, NUMSAMPLES, cfg);
+    dec.SetProfile(enc.GetProfile());
+    dec.SetNumSamples(NUMSAMPLES);
+    dec.framestats = enc.framestats;
+    dec.encoded = enc.encoded;
+    dec.Decode();
+    dec.Unpredict();
+
+    for(std::int32_t ch = 0; ch < 2; ch++) {
+      for(std::int32_t i = 0; i < NUMSAMPLES; i++) {
+        if(dec.samples[ch][i] != input[ch][i]) {
+          std::cerr << "mt-mode " << mt_mode << ": mismatch in channel " << ch
+                    << " at sample " << i << '\n';
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+} // namespace
+
+std::int32_t main() {
+  bool ok = true;
+  for(std::int32_t mt_mode: {0, 3}) { ok = RoundTrip(mt_mode) && ok; }
+  std::cout << (ok ? "ok" : "failed") << '\n';
+  return ok ? 0 : 1;
+}